@@ -0,0 +1,188 @@
+# Compiles the generated translation units with and without ustr and prints
+# where the compile time goes. Run through the ustr_compile_time target:
+#
+#   cmake -DCOMPILER=... -DCOMPILER_ID=GNU|Clang -DFLAGS="-std=c++11|-I...|-O0"
+#         -DSOURCES="a.cpp|b.cpp" -DWORK_DIR=... -P compile_time_report.cmake
+#         [-DBUDGET_MS=N] [-DJSON=path]
+#
+# GCC is run with -ftime-report (phase and template instantiation times),
+# clang with -ftime-trace, whose events also attribute instantiation time
+# to ustr:: templates. Every unit is compiled a second time with
+# -DUSTR_COMPILE_BENCH_CONTROL, which builds the same values without ustr;
+# the difference is reported as the ustr overhead. With BUDGET_MS > 0 the
+# script fails when the average overhead per unit exceeds the budget.
+
+cmake_minimum_required(VERSION 3.10)
+
+foreach(var COMPILER COMPILER_ID FLAGS SOURCES WORK_DIR)
+    if(NOT DEFINED ${var})
+        message(FATAL_ERROR "compile_time_report.cmake: ${var} is not set")
+    endif()
+endforeach()
+string(REPLACE "|" ";" FLAGS "${FLAGS}")
+string(REPLACE "|" ";" SOURCES "${SOURCES}")
+if(NOT DEFINED BUDGET_MS)
+    set(BUDGET_MS 0)
+endif()
+
+# "1.25" seconds -> 1250 milliseconds (CMake arithmetic is integer only)
+function(ct_seconds_to_ms seconds out)
+    if(seconds MATCHES "^([0-9]+)\\.([0-9]+)$")
+        set(whole ${CMAKE_MATCH_1})
+        string(SUBSTRING "${CMAKE_MATCH_2}000" 0 3 fraction)
+        string(REGEX REPLACE "^0+([0-9])" "\\1" fraction "${fraction}")
+        math(EXPR ms "${whole} * 1000 + ${fraction}")
+    elseif(seconds MATCHES "^[0-9]+$")
+        math(EXPR ms "${seconds} * 1000")
+    else()
+        set(ms 0)
+    endif()
+    set(${out} ${ms} PARENT_SCOPE)
+endfunction()
+
+# Wall-clock column of a -ftime-report line, in milliseconds
+function(ct_gcc_phase report label out)
+    set(ms 0)
+    string(REGEX MATCH " ${label} *:[^\n]*" line "${report}")
+    if(line)
+        # usr, sys and wall columns, each optionally followed by a percentage
+        string(REGEX MATCHALL "[0-9]+\\.[0-9]+" numbers "${line}")
+        list(LENGTH numbers count)
+        if(count GREATER 2)
+            list(GET numbers 2 wall)
+            ct_seconds_to_ms(${wall} ms)
+        endif()
+    endif()
+    set(${out} ${ms} PARENT_SCOPE)
+endfunction()
+
+# Sum of "dur" (microseconds) of -ftime-trace events matching a pattern, in milliseconds
+function(ct_clang_events trace pattern out)
+    string(REGEX MATCHALL "\"dur\":[0-9]+,\"name\":${pattern}" events "${trace}")
+    set(us 0)
+    foreach(event ${events})
+        string(REGEX MATCH "\"dur\":([0-9]+)" ignored "${event}")
+        math(EXPR us "${us} + ${CMAKE_MATCH_1}")
+    endforeach()
+    math(EXPR ms "${us} / 1000")
+    set(${out} ${ms} PARENT_SCOPE)
+endfunction()
+
+# Compiles one unit; sets <prefix>_total, <prefix>_parse, <prefix>_templates and
+# <prefix>_ustr (templates in namespace ustr, clang only, otherwise -1)
+function(ct_compile source control prefix)
+    get_filename_component(name ${source} NAME_WE)
+    set(defines)
+    if(control)
+        set(name ${name}_control)
+        set(defines -DUSTR_COMPILE_BENCH_CONTROL)
+    endif()
+    set(object ${WORK_DIR}/${name}.o)
+
+    if(COMPILER_ID MATCHES "Clang")
+        set(time_flags -ftime-trace -ftime-trace-granularity=50)
+    else()
+        set(time_flags -ftime-report)
+    endif()
+    execute_process(
+        COMMAND ${COMPILER} ${FLAGS} ${defines} ${time_flags} -c ${source} -o ${object}
+        RESULT_VARIABLE result
+        OUTPUT_VARIABLE output
+        ERROR_VARIABLE report
+    )
+    if(NOT result EQUAL 0)
+        message(FATAL_ERROR "Compiling ${source} failed:\n${report}")
+    endif()
+
+    if(COMPILER_ID MATCHES "Clang")
+        file(READ ${WORK_DIR}/${name}.json trace)
+        ct_clang_events("${trace}" "\"Total ExecuteCompiler\"" total)
+        ct_clang_events("${trace}" "\"Total Source\"" parse)
+        ct_clang_events("${trace}" "\"Total Instantiate(Function|Class)\"" templates)
+        ct_clang_events("${trace}" "\"Instantiate(Function|Class)\",\"args\":{\"detail\":\"ustr::" ustr)
+    else()
+        ct_gcc_phase("${report}" "TOTAL" total)
+        ct_gcc_phase("${report}" "phase parsing" parse)
+        ct_gcc_phase("${report}" "template instantiation" templates)
+        set(ustr -1)
+    endif()
+    set(${prefix}_total ${total} PARENT_SCOPE)
+    set(${prefix}_parse ${parse} PARENT_SCOPE)
+    set(${prefix}_templates ${templates} PARENT_SCOPE)
+    set(${prefix}_ustr ${ustr} PARENT_SCOPE)
+endfunction()
+
+function(ct_pad text width out)
+    string(LENGTH "${text}" length)
+    while(length LESS width)
+        set(text "${text} ")
+        math(EXPR length "${length} + 1")
+    endwhile()
+    set(${out} "${text} " PARENT_SCOPE)
+endfunction()
+
+file(MAKE_DIRECTORY ${WORK_DIR})
+string(REPLACE ";" " " flag_text "${FLAGS}")
+message("Compile time of ustr.h (${COMPILER_ID}, flags: ${flag_text})")
+message("")
+ct_pad("Unit" 28 h1)
+ct_pad("Total ms" 10 h2)
+ct_pad("Parse ms" 10 h3)
+ct_pad("Templ ms" 10 h4)
+ct_pad("ustr:: ms" 10 h5)
+ct_pad("Control ms" 12 h6)
+message("${h1}${h2}${h3}${h4}${h5}${h6}Overhead ms")
+
+set(units 0)
+set(sum_total 0)
+set(sum_control 0)
+set(sum_templates 0)
+set(sum_control_templates 0)
+set(json_entries)
+foreach(source ${SOURCES})
+    ct_compile(${source} FALSE u)
+    ct_compile(${source} TRUE c)
+    math(EXPR overhead "${u_total} - ${c_total}")
+    math(EXPR units "${units} + 1")
+    math(EXPR sum_total "${sum_total} + ${u_total}")
+    math(EXPR sum_control "${sum_control} + ${c_total}")
+    math(EXPR sum_templates "${sum_templates} + ${u_templates}")
+    math(EXPR sum_control_templates "${sum_control_templates} + ${c_templates}")
+
+    get_filename_component(name ${source} NAME)
+    set(ustr_column "-")
+    if(u_ustr GREATER -1)
+        set(ustr_column ${u_ustr})
+    endif()
+    ct_pad("${name}" 28 c1)
+    ct_pad("${u_total}" 10 c2)
+    ct_pad("${u_parse}" 10 c3)
+    ct_pad("${u_templates}" 10 c4)
+    ct_pad("${ustr_column}" 10 c5)
+    ct_pad("${c_total}" 12 c6)
+    message("${c1}${c2}${c3}${c4}${c5}${c6}${overhead}")
+    list(APPEND json_entries
+        "    {\"name\": \"${name}\", \"total_ms\": ${u_total}, \"parse_ms\": ${u_parse}, \"templates_ms\": ${u_templates}, \"ustr_templates_ms\": ${u_ustr}, \"control_ms\": ${c_total}}")
+endforeach()
+
+if(units EQUAL 0)
+    message(FATAL_ERROR "No translation units to compile")
+endif()
+math(EXPR avg_total "${sum_total} / ${units}")
+math(EXPR avg_control "${sum_control} / ${units}")
+math(EXPR avg_overhead "(${sum_total} - ${sum_control}) / ${units}")
+math(EXPR avg_templates "${sum_templates} / ${units}")
+math(EXPR avg_control_templates "${sum_control_templates} / ${units}")
+message("")
+message("Average per unit: ${avg_total} ms with ustr, ${avg_control} ms without, "
+        "ustr overhead ${avg_overhead} ms (template instantiation ${avg_templates} ms vs ${avg_control_templates} ms)")
+
+if(DEFINED JSON AND NOT JSON STREQUAL "")
+    string(REPLACE ";" ",\n" json_body "${json_entries}")
+    file(WRITE ${JSON} "{\n  \"compiler\": \"${COMPILER_ID}\",\n  \"average_overhead_ms\": ${avg_overhead},\n  \"units\": [\n${json_body}\n  ]\n}\n")
+    message("Results written to ${JSON}")
+endif()
+
+if(BUDGET_MS GREATER 0 AND avg_overhead GREATER BUDGET_MS)
+    message(FATAL_ERROR "ustr compile-time overhead ${avg_overhead} ms per unit exceeds the budget of ${BUDGET_MS} ms")
+endif()
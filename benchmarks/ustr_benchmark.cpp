@@ -0,0 +1,243 @@
+// Benchmarks for ustr conversion paths, compared against baseline.json by
+// the perf-regression CTest entry (see benchmarks/CMakeLists.txt).
+
+#include "../include/ustr/ustr.h"
+#include "../include/ustr/csv_writer.h"
+#include "../include/utest/utest_bench.h"
+#include <vector>
+#include <string>
+#include <map>
+#include <tuple>
+#include <memory>
+#include <sstream>
+
+UTEST_BENCH_COUNT_ALLOCATIONS()
+
+namespace {
+
+const std::vector<int>& intValues() {
+    static const std::vector<int> values = [] {
+        std::vector<int> v;
+        for (int i = 0; i < 1000; ++i) {
+            v.push_back(i * 7919 - 500000);
+        }
+        return v;
+    }();
+    return values;
+}
+
+const std::vector<double>& doubleValues() {
+    static const std::vector<double> values = [] {
+        std::vector<double> v;
+        for (int i = 0; i < 100; ++i) {
+            v.push_back(i * 0.125 - 3.5);
+        }
+        return v;
+    }();
+    return values;
+}
+
+const std::map<std::string, int>& wordCounts() {
+    static const std::map<std::string, int> counts = {
+        {"alpha", 1}, {"beta", 2}, {"gamma", 3}, {"delta", 4}, {"epsilon", 5},
+        {"zeta", 6}, {"eta", 7}, {"theta", 8}, {"iota", 9}, {"kappa", 10}
+    };
+    return counts;
+}
+
+const ustr::format_context& customContext() {
+    static const ustr::format_context ctx = [] {
+        ustr::format_context c;
+        c.set_formatter<int>([](int i) { return "#" + std::to_string(i); });
+        c.set_formatter<bool>([](bool b) { return b ? "yes" : "no"; });
+        return c;
+    }();
+    return ctx;
+}
+
+typedef std::tuple<int, std::string, double, bool> CsvRow;
+
+// 1,000 rows of about 40 bytes, one in ten needing quotes
+const std::vector<CsvRow>& csvRows() {
+    static const std::vector<CsvRow> rows = [] {
+        std::vector<CsvRow> v;
+        for (int i = 0; i < 1000; ++i) {
+            std::string name = (i % 10 == 0) ? "name, with \"quotes\"" : "plain name " + std::to_string(i);
+            v.push_back(CsvRow(i * 7919, name, i * 0.25, i % 2 == 0));
+        }
+        return v;
+    }();
+    return rows;
+}
+
+// Same output as customContext() for int, with a formatter appending to the output buffer
+const ustr::format_context& bufferContext() {
+    static const ustr::format_context ctx = [] {
+        ustr::format_context c;
+        c.set_formatter<int>([](int i, std::string& out) {
+            out += '#';
+            ustr::append_to(out, i);
+        });
+        return c;
+    }();
+    return ctx;
+}
+
+// Distinct types for a context with many formatters
+template<int N>
+struct Tagged {
+    int value;
+};
+
+template<int N>
+void addTaggedFormatter(ustr::format_context& ctx) {
+    ctx.set_formatter<Tagged<N>>([](const Tagged<N>& t) { return std::to_string(N) + ":" + std::to_string(t.value); });
+}
+
+template<int Base>
+void addTenTaggedFormatters(ustr::format_context& ctx) {
+    addTaggedFormatter<Base>(ctx);
+    addTaggedFormatter<Base + 1>(ctx);
+    addTaggedFormatter<Base + 2>(ctx);
+    addTaggedFormatter<Base + 3>(ctx);
+    addTaggedFormatter<Base + 4>(ctx);
+    addTaggedFormatter<Base + 5>(ctx);
+    addTaggedFormatter<Base + 6>(ctx);
+    addTaggedFormatter<Base + 7>(ctx);
+    addTaggedFormatter<Base + 8>(ctx);
+    addTaggedFormatter<Base + 9>(ctx);
+}
+
+template<int Base>
+void addHundredTaggedFormatters(ustr::format_context& ctx) {
+    addTenTaggedFormatters<Base>(ctx);
+    addTenTaggedFormatters<Base + 10>(ctx);
+    addTenTaggedFormatters<Base + 20>(ctx);
+    addTenTaggedFormatters<Base + 30>(ctx);
+    addTenTaggedFormatters<Base + 40>(ctx);
+    addTenTaggedFormatters<Base + 50>(ctx);
+    addTenTaggedFormatters<Base + 60>(ctx);
+    addTenTaggedFormatters<Base + 70>(ctx);
+    addTenTaggedFormatters<Base + 80>(ctx);
+    addTenTaggedFormatters<Base + 90>(ctx);
+}
+
+// Context with 1,000 registered formatters
+const ustr::format_context& largeContext() {
+    static const ustr::format_context ctx = [] {
+        ustr::format_context c;
+        addHundredTaggedFormatters<0>(c);
+        addHundredTaggedFormatters<100>(c);
+        addHundredTaggedFormatters<200>(c);
+        addHundredTaggedFormatters<300>(c);
+        addHundredTaggedFormatters<400>(c);
+        addHundredTaggedFormatters<500>(c);
+        addHundredTaggedFormatters<600>(c);
+        addHundredTaggedFormatters<700>(c);
+        addHundredTaggedFormatters<800>(c);
+        addHundredTaggedFormatters<900>(c);
+        return c;
+    }();
+    return ctx;
+}
+
+} // namespace
+
+UTEST_BENCH_DEF2(ToString, Int) {
+    utest::bench::doNotOptimize(ustr::to_string(123456789));
+}
+
+UTEST_BENCH_DEF2(ToString, Double) {
+    utest::bench::doNotOptimize(ustr::to_string(3.14159265358979));
+}
+
+UTEST_BENCH_DEF2(ToString, VectorInt1000) {
+    utest::bench::doNotOptimize(ustr::to_string(intValues()));
+}
+
+UTEST_BENCH_DEF2(ToString, VectorDouble100) {
+    utest::bench::doNotOptimize(ustr::to_string(doubleValues()));
+}
+
+UTEST_BENCH_DEF2(ToString, MapStringInt) {
+    utest::bench::doNotOptimize(ustr::to_string(wordCounts()));
+}
+
+UTEST_BENCH_DEF2(ToString, Tuple) {
+    utest::bench::doNotOptimize(ustr::to_string(std::make_tuple(42, 2.5, "name", true)));
+}
+
+UTEST_BENCH_DEF2(QuotedStr, Plain) {
+    static const std::string text = "the quick brown fox jumps over the lazy dog";
+    utest::bench::doNotOptimize(ustr::quoted_str(text));
+}
+
+UTEST_BENCH_DEF2(QuotedStr, Escapes) {
+    static const std::string text = "say \"hi\"\n\tpath C:\\temp\\file \"quoted\" again";
+    utest::bench::doNotOptimize(ustr::quoted_str(text));
+}
+
+UTEST_BENCH_DEF2(CsvWriter, Rows1000) {
+    static std::string out;
+    out.clear();
+    {
+        ustr::csv_writer writer(out);
+        writer.write_rows(csvRows());
+    }
+    utest::bench::setBytesPerOp(out.size());
+    utest::bench::doNotOptimize(out);
+}
+
+UTEST_BENCH_DEF2(CsvWriter, Rows1000Stream) {
+    static std::ostringstream stream;
+    stream.str(std::string());
+    {
+        ustr::csv_writer writer(stream);
+        writer.write_rows(csvRows());
+    }
+    utest::bench::setBytesPerOp(static_cast<std::size_t>(stream.tellp()));
+    utest::bench::doNotOptimize(stream);
+}
+
+UTEST_BENCH_DEF2(FormatContext, CustomInt) {
+    utest::bench::doNotOptimize(customContext().to_string(12345));
+}
+
+UTEST_BENCH_DEF2(FormatContext, DefaultDouble) {
+    utest::bench::doNotOptimize(customContext().to_string(2.75));
+}
+
+UTEST_BENCH_DEF2(FormatContext, VectorIntFormatter) {
+    utest::bench::doNotOptimize(customContext().to_string(intValues()));
+}
+
+UTEST_BENCH_DEF2(FormatContext, VectorIntBufferFormatter) {
+    utest::bench::doNotOptimize(bufferContext().to_string(intValues()));
+}
+
+UTEST_BENCH_DEF2(FormatContext, Copy1000Formatters) {
+    ustr::format_context copy(largeContext());
+    utest::bench::doNotOptimize(copy);
+}
+
+UTEST_BENCH_DEF2(FormatContext, CopyFirstLookup1000Formatters) {
+    ustr::format_context copy(largeContext());
+    utest::bench::doNotOptimize(copy.to_string(Tagged<500>{7}));
+}
+
+UTEST_BENCH_DEF2(FormatContext, CopyOverride1000Formatters) {
+    // The first change copies the shared table; compare with ChildOverride1000Formatters
+    ustr::format_context copy(largeContext());
+    copy.set_formatter<bool>([](bool b) { return b ? "yes" : "no"; });
+    utest::bench::doNotOptimize(copy.to_string(true));
+}
+
+UTEST_BENCH_DEF2(FormatContext, ChildOverride1000Formatters) {
+    static const std::shared_ptr<const ustr::format_context> parent =
+        std::make_shared<const ustr::format_context>(largeContext());
+    ustr::format_context child(parent);
+    child.set_formatter<bool>([](bool b) { return b ? "yes" : "no"; });
+    utest::bench::doNotOptimize(child.to_string(Tagged<500>{7}));
+}
+
+UTEST_BENCH_MAIN()
@@ -0,0 +1,42 @@
+# Helpers for registering utest binaries with CTest
+#
+# ustr_add_test(<target> [SOURCES <files>...] [LABELS <labels>...] [ARGS <args>...])
+#
+# Builds <target> (from <target>.cpp unless SOURCES is given), links it with
+# ustr::ustr, places it in ${CMAKE_BINARY_DIR}/bin and registers it with CTest
+# under the name <target>s. Each binary runs all tests it defines (see
+# UTEST_RUN_REGISTERED), so `ctest -j` runs binaries concurrently and
+# `ctest -L <label>` selects them by label (unit, bench, perf-regression).
+# ARGS are passed to the binary, e.g. --filter or --shard options.
+# UTEST_USE_USTR is defined for every binary, so assertion messages are
+# formatted with ustr regardless of include order.
+
+include(ProcessorCount)
+ProcessorCount(USTR_TEST_JOBS)
+if(USTR_TEST_JOBS EQUAL 0)
+    set(USTR_TEST_JOBS 1)
+endif()
+
+function(ustr_add_test target)
+    cmake_parse_arguments(USTR_TEST "" "" "SOURCES;LABELS;ARGS" ${ARGN})
+    if(NOT USTR_TEST_SOURCES)
+        set(USTR_TEST_SOURCES ${target}.cpp)
+    endif()
+    if(NOT USTR_TEST_LABELS)
+        set(USTR_TEST_LABELS unit)
+    endif()
+
+    add_executable(${target} ${USTR_TEST_SOURCES})
+    target_link_libraries(${target} PRIVATE ustr::ustr)
+    target_compile_definitions(${target} PRIVATE UTEST_USE_USTR=1)
+    set_target_properties(${target} PROPERTIES
+        RUNTIME_OUTPUT_DIRECTORY ${CMAKE_BINARY_DIR}/bin
+    )
+    if(CMAKE_BUILD_TYPE STREQUAL "Debug")
+        target_compile_definitions(${target} PRIVATE DEBUG=1)
+    endif()
+
+    add_test(NAME ${target}s COMMAND ${target} ${USTR_TEST_ARGS})
+    set_tests_properties(${target}s PROPERTIES LABELS "${USTR_TEST_LABELS}")
+    set_property(GLOBAL APPEND PROPERTY USTR_TEST_TARGETS ${target})
+endfunction()
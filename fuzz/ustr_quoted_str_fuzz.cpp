@@ -0,0 +1,85 @@
+// Fuzz target for quoted_str / unquoted_str
+//
+// Built with clang this is a libFuzzer target (-fsanitize=fuzzer). With other
+// compilers USTR_FUZZ_STANDALONE adds a main() that replays the files given
+// on the command line, e.g. the seed corpus or a crash reproducer.
+
+#include "../include/ustr/ustr.h"
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <iterator>
+#include <string>
+
+namespace {
+
+struct Quotation {
+    char start;
+    char end;
+    char escape;
+};
+
+const Quotation quotations[] = {
+    {'"', '"', '\\'},
+    {'[', ']', '/'},
+    {'<', '>', '\\'},
+    {'"', '"', '"'},
+    {'{', '}', '{'},
+};
+
+void check(bool condition, const char* what) {
+    if (!condition) {
+        std::fprintf(stderr, "ustr fuzz check failed: %s\n", what);
+        std::abort();
+    }
+}
+
+std::string withoutBom(const std::string& s) {
+    if (s.size() >= 3 && s.compare(0, 3, "\xEF\xBB\xBF") == 0) {
+        return s.substr(3);
+    }
+    return s;
+}
+
+} // namespace
+
+extern "C" int LLVMFuzzerTestOneInput(const std::uint8_t* data, std::size_t size) {
+    if (size == 0) {
+        return 0;
+    }
+    // First byte selects the quotation style and UTF-8 mode, the rest is the input
+    const Quotation& q = quotations[data[0] % (sizeof(quotations) / sizeof(quotations[0]))];
+    const bool is_utf8 = (data[0] & 0x80) != 0;
+    const std::string input(reinterpret_cast<const char*>(data + 1), size - 1);
+
+    std::string text;
+    const std::string quoted = ustr::quoted_str(input, q.start, q.end, q.escape, is_utf8);
+    check(ustr::unquoted_str(quoted, text, q.start, q.end, q.escape, is_utf8), "quoted output is accepted");
+    check(text == withoutBom(input), "round-trip restores the input");
+
+    // Arbitrary input must be rejected or parsed into something that round-trips
+    if (ustr::unquoted_str(input, text, q.start, q.end, q.escape, is_utf8)) {
+        std::string again;
+        check(ustr::unquoted_str(ustr::quoted_str(text, q.start, q.end, q.escape, is_utf8), again,
+                                 q.start, q.end, q.escape, is_utf8), "re-quoted output is accepted");
+        check(again == withoutBom(text), "re-quoted output round-trips");
+    }
+    return 0;
+}
+
+#ifdef USTR_FUZZ_STANDALONE
+int main(int argc, char* argv[]) {
+    for (int i = 1; i < argc; ++i) {
+        std::ifstream file(argv[i], std::ios::binary);
+        if (!file) {
+            std::fprintf(stderr, "cannot open %s\n", argv[i]);
+            return EXIT_FAILURE;
+        }
+        const std::string bytes((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+        LLVMFuzzerTestOneInput(reinterpret_cast<const std::uint8_t*>(bytes.data()), bytes.size());
+    }
+    std::printf("Replayed %d inputs\n", argc - 1);
+    return EXIT_SUCCESS;
+}
+#endif
@@ -0,0 +1,410 @@
+#ifndef __USTR_CSV_WRITER_H__
+#define __USTR_CSV_WRITER_H__
+
+/**
+ * @file csv_writer.h
+ * @brief Buffered CSV/TSV writer built on ustr conversions
+ *
+ * Writes rows of tuples, pairs or structs exposing a tuple view directly into
+ * an output buffer using ustr's append-based conversion kernels. Fields are
+ * quoted according to RFC 4180 only when they contain the delimiter, the quote
+ * character or a line break; the check is done while the field is copied.
+ * The buffer is flushed to the target in chunks.
+ *
+ * @code{.cpp}
+ * #include "ustr/csv_writer.h"
+ *
+ * std::vector<std::tuple<int, std::string, double>> rows = ...;
+ * std::ofstream file("out.csv");
+ * ustr::csv_writer writer(file);
+ * writer.write_fields("id", "name", "score");
+ * writer.write_rows(rows);
+ * writer.flush();
+ * @endcode
+ */
+
+#include "ustr.h"
+
+#include <cstdio>
+#include <cstring>
+#include <ostream>
+
+namespace ustr {
+
+/**
+ * @brief Options controlling CSV output
+ */
+struct csv_options {
+    char delimiter;               ///< Field separator, ',' for CSV or '\t' for TSV
+    char quote;                   ///< Quote character used for fields that need quoting
+    std::string line_terminator;  ///< Written after each row
+    std::size_t flush_threshold;  ///< Buffer size that triggers a flush to the target
+
+    csv_options(char delim = ',',
+                char quote_char = '"',
+                std::string terminator = "\n",
+                std::size_t threshold = 1 << 20)
+        : delimiter(delim),
+          quote(quote_char),
+          line_terminator(std::move(terminator)),
+          flush_threshold(threshold) {}
+};
+
+/**
+ * @brief Detects types exposing their fields through an as_tuple() method
+ *
+ * Structs can be written as CSV rows by returning a tuple (usually std::tie)
+ * of their fields:
+ *
+ * @code{.cpp}
+ * struct Trade {
+ *     int id; std::string symbol; double price;
+ *     std::tuple<const int&, const std::string&, const double&> as_tuple() const {
+ *         return std::tie(id, symbol, price);
+ *     }
+ * };
+ * @endcode
+ */
+template<typename T>
+struct has_as_tuple {
+private:
+    template<typename U>
+    static auto test(int) -> decltype(
+        std::declval<const U&>().as_tuple(),
+        std::true_type{}
+    );
+
+    template<typename>
+    static std::false_type test(...);
+
+public:
+    static const bool value = decltype(test<T>(0))::value;
+};
+
+namespace details {
+
+// Characters that force quoting of a CSV field
+inline bool csv_needs_quoting(char c, char delimiter, char quote) {
+    return c == delimiter || c == quote || c == '\n' || c == '\r';
+}
+
+// Copies a string field, quoting it only if a special character is found.
+// Plain fields are copied in a single pass; on the first special character
+// the already copied prefix is wrapped in quotes and escaping continues.
+inline void append_csv_string(std::string& out, const char* s, std::size_t length,
+                              char delimiter, char quote) {
+    std::size_t i = 0;
+    for (; i < length; ++i) {
+        if (csv_needs_quoting(s[i], delimiter, quote)) {
+            break;
+        }
+    }
+    if (i == length) {
+        out.append(s, length);
+        return;
+    }
+    out += quote;
+    out.append(s, i);
+    std::size_t run_start = i;
+    for (; i < length; ++i) {
+        if (s[i] == quote) {
+            out.append(s + run_start, i - run_start + 1);
+            out += quote;
+            run_start = i + 1;
+        }
+    }
+    out.append(s + run_start, length - run_start);
+    out += quote;
+}
+
+inline void append_csv_special(std::string& out, const std::string& value, char delimiter, char quote) {
+    append_csv_string(out, value.data(), value.size(), delimiter, quote);
+}
+
+inline void append_csv_special(std::string& out, const char* value, char delimiter, char quote) {
+    const char* s = value ? value : get_null_string();
+    append_csv_string(out, s, std::strlen(s), delimiter, quote);
+}
+
+#if __cplusplus >= 201703L
+inline void append_csv_special(std::string& out, std::string_view value, char delimiter, char quote) {
+    append_csv_string(out, value.data(), value.size(), delimiter, quote);
+}
+#endif
+
+// Numbers never need quoting: written straight with the numeric kernels
+template<typename T>
+inline auto append_csv_field(std::string& out, const T& value, char, char)
+    -> typename std::enable_if<
+        uses_builtin_conversion<T>::value &&
+        is_numeric<T>::value
+    >::type {
+    append_value(out, value);
+}
+
+// Strings are escaped while being copied
+template<typename T>
+inline auto append_csv_field(std::string& out, const T& value, char delimiter, char quote)
+    -> typename std::enable_if<
+        uses_builtin_conversion<T>::value &&
+        is_quotable_string<T>::value
+    >::type {
+    append_csv_special(out, value, delimiter, quote);
+}
+
+// Other values are converted in place and quoted afterwards if required
+template<typename T>
+inline auto append_csv_field(std::string& out, const T& value, char delimiter, char quote)
+    -> typename std::enable_if<
+        !(uses_builtin_conversion<T>::value &&
+          (is_numeric<T>::value || is_quotable_string<T>::value))
+    >::type {
+    const std::size_t start = out.size();
+    append_value(out, value);
+    for (std::size_t i = start; i < out.size(); ++i) {
+        if (csv_needs_quoting(out[i], delimiter, quote)) {
+            const std::string field = out.substr(start);
+            out.resize(start);
+            append_csv_string(out, field.data(), field.size(), delimiter, quote);
+            return;
+        }
+    }
+}
+
+} // namespace details
+
+/**
+ * @brief Buffered writer producing CSV (or TSV) rows
+ *
+ * Rows can be std::tuple, std::pair, any type with an as_tuple() method or a
+ * struct registered with USTR_REFLECT.
+ * Output goes to an internal buffer that is flushed to the target when it
+ * exceeds csv_options::flush_threshold, on flush() and on destruction.
+ * A failed write to the target (full disk, closed pipe) is sticky: flush()
+ * returns false and good() reports it from then on.
+ * When constructed with a std::string target, rows are appended to that
+ * string directly and no intermediate buffer is used.
+ */
+class csv_writer {
+private:
+    typedef bool (*sink_func)(void* target, const char* data, std::size_t size);
+
+    csv_options options_;
+    std::string own_buffer_;
+    std::string* buffer_;
+    void* target_;
+    sink_func sink_;
+    std::size_t rows_written_;
+    bool good_;
+
+    static bool write_to_stream(void* target, const char* data, std::size_t size) {
+        std::ostream& stream = *static_cast<std::ostream*>(target);
+        stream.write(data, static_cast<std::streamsize>(size));
+        return !stream.fail();
+    }
+
+    // The C stream is flushed as well, so write errors show up here and not at fclose()
+    static bool write_to_file(void* target, const char* data, std::size_t size) {
+        std::FILE* file = static_cast<std::FILE*>(target);
+        return std::fwrite(data, 1, size, file) == size && std::fflush(file) == 0;
+    }
+
+    template<typename T>
+    void write_field(const T& value, bool first) {
+        if (!first) {
+            *buffer_ += options_.delimiter;
+        }
+        details::append_csv_field(*buffer_, value, options_.delimiter, options_.quote);
+    }
+
+    template<typename Tuple, std::size_t... Indices>
+    void write_tuple(const Tuple& row, details::index_sequence<Indices...>) {
+        (void)std::initializer_list<int>{(write_field(std::get<Indices>(row), Indices == 0), 0)...};
+    }
+
+    // Writes the fields of a struct registered with USTR_REFLECT
+    struct reflected_value_writer {
+        csv_writer& writer;
+        bool first;
+
+        template<typename M>
+        void operator()(const char*, const M& field_value) {
+            writer.write_field(field_value, first);
+            first = false;
+        }
+    };
+
+    // Writes the field names of a struct registered with USTR_REFLECT
+    struct reflected_name_writer {
+        csv_writer& writer;
+        bool first;
+
+        void operator()(const char* name) {
+            writer.write_field(name, first);
+            first = false;
+        }
+    };
+
+    typedef std::integral_constant<int, 0> tuple_row_tag;
+    typedef std::integral_constant<int, 1> as_tuple_row_tag;
+    typedef std::integral_constant<int, 2> reflected_row_tag;
+
+    template<typename Row>
+    struct row_tag : std::integral_constant<int,
+        details::is_reflectable<Row>::value ? 2 : (has_as_tuple<Row>::value ? 1 : 0)> {};
+
+    template<typename Row>
+    void write_row_impl(const Row& row, as_tuple_row_tag) {
+        write_row(row.as_tuple());
+    }
+
+    template<typename Row>
+    void write_row_impl(const Row& row, tuple_row_tag) {
+        write_tuple(row, details::make_index_sequence<std::tuple_size<Row>::value>{});
+        end_row();
+    }
+
+    template<typename Row>
+    void write_row_impl(const Row& row, reflected_row_tag) {
+        reflected_value_writer visitor = {*this, true};
+        details::visit_reflected_fields(row, visitor);
+        end_row();
+    }
+
+    void end_row() {
+        *buffer_ += options_.line_terminator;
+        ++rows_written_;
+        if (sink_ && buffer_->size() >= options_.flush_threshold) {
+            flush();
+        }
+    }
+
+    void init_buffer() {
+        own_buffer_.reserve(options_.flush_threshold + options_.flush_threshold / 8);
+    }
+
+public:
+    /**
+     * @brief Write rows to an output stream
+     * @param out Target stream, must outlive the writer
+     * @param options Delimiters and buffering options
+     */
+    explicit csv_writer(std::ostream& out, const csv_options& options = csv_options())
+        : options_(options), own_buffer_(), buffer_(&own_buffer_),
+          target_(&out), sink_(&write_to_stream), rows_written_(0), good_(true) {
+        init_buffer();
+    }
+
+    /**
+     * @brief Write rows to a C stream (use fdopen() for file descriptors)
+     * @param file Target file, must outlive the writer
+     * @param options Delimiters and buffering options
+     */
+    explicit csv_writer(std::FILE* file, const csv_options& options = csv_options())
+        : options_(options), own_buffer_(), buffer_(&own_buffer_),
+          target_(file), sink_(&write_to_file), rows_written_(0), good_(true) {
+        init_buffer();
+    }
+
+    /**
+     * @brief Append rows directly to a string, without intermediate buffering
+     * @param out Target string, must outlive the writer
+     * @param options Delimiters options (flush_threshold is ignored)
+     */
+    explicit csv_writer(std::string& out, const csv_options& options = csv_options())
+        : options_(options), own_buffer_(), buffer_(&out),
+          target_(nullptr), sink_(nullptr), rows_written_(0), good_(true) {}
+
+    csv_writer(const csv_writer&) = delete;
+    csv_writer& operator=(const csv_writer&) = delete;
+
+    ~csv_writer() {
+        flush();
+    }
+
+    /**
+     * @brief Write a single row
+     * @tparam Row std::tuple, std::pair, type with as_tuple() or type registered with USTR_REFLECT
+     */
+    template<typename Row>
+    void write_row(const Row& row) {
+        write_row_impl(row, std::integral_constant<int, row_tag<Row>::value>{});
+    }
+
+    /**
+     * @brief Write a header row with the field names of a struct registered with USTR_REFLECT
+     *
+     * @code{.cpp}
+     * writer.write_header<Trade>();   // id,symbol,price
+     * @endcode
+     */
+    template<typename Row>
+    void write_header() {
+        static_assert(details::is_reflectable<Row>::value, "write_header requires a type registered with USTR_REFLECT");
+        reflected_name_writer visitor = {*this, true};
+        details::visit_reflected_field_names<Row>(visitor);
+        end_row();
+    }
+
+    /**
+     * @brief Write a row made of the given values
+     *
+     * @code{.cpp}
+     * writer.write_fields("id", "name", "price");  // header
+     * writer.write_fields(1, "apple", 0.5);
+     * @endcode
+     */
+    template<typename... Fields>
+    void write_fields(const Fields&... fields) {
+        bool first = true;
+        (void)std::initializer_list<int>{(write_field(fields, first), first = false, 0)...};
+        (void)first;
+        end_row();
+    }
+
+    /**
+     * @brief Write all rows of a range
+     * @tparam RangeT Range of rows accepted by write_row()
+     */
+    template<typename RangeT>
+    void write_rows(const RangeT& rows) {
+        for (auto it = std::begin(rows); it != std::end(rows); ++it) {
+            write_row(*it);
+        }
+    }
+
+    /**
+     * @brief Flush buffered output to the target
+     * @return false if this or an earlier write to the target failed
+     */
+    bool flush() {
+        if (sink_ && !buffer_->empty()) {
+            if (!sink_(target_, buffer_->data(), buffer_->size())) {
+                good_ = false;
+            }
+            buffer_->clear();
+        }
+        return good_;
+    }
+
+    /**
+     * @brief Check that every write to the target so far succeeded
+     */
+    bool good() const {
+        return good_;
+    }
+
+    /**
+     * @brief Number of rows written so far (including header rows)
+     *
+     * Rows are counted when they are buffered; check good() or the result of
+     * flush() to know whether they reached the target.
+     */
+    std::size_t rows_written() const {
+        return rows_written_;
+    }
+};
+
+} // namespace ustr
+
+#endif // __USTR_CSV_WRITER_H__
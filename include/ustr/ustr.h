@@ -74,19 +74,43 @@
  * @endcode
  */
 
+#include <atomic>
+#include <cstdio>
+#include <cstdint>
+#include <cstring>
 #include <string>
 #include <sstream>
 #include <type_traits>
 #include <typeinfo>
 #include <typeindex>
 #include <functional>
+#include <iterator>
+#include <limits>
 #include <map>
 #include <memory>
+#include <new>
 #include <tuple>
+#include <vector>
 
-// Include string_view for C++17 and later
+// Include string_view and vocabulary types for C++17 and later
 #if __cplusplus >= 201703L
 #include <string_view>
+#include <optional>
+#include <variant>
+#include <any>
+#endif
+
+// Compiler-specific function signature used to extract type names at compile time
+#if defined(__clang__) || defined(__GNUC__)
+#define USTR_FUNCTION_SIGNATURE_ __PRETTY_FUNCTION__
+#elif defined(_MSC_VER)
+#define USTR_FUNCTION_SIGNATURE_ __FUNCSIG__
+#endif
+
+#if __cplusplus >= 201703L
+#define USTR_CONSTEXPR17_ constexpr
+#else
+#define USTR_CONSTEXPR17_
 #endif
 
 namespace ustr {
@@ -366,6 +390,18 @@ constexpr bool DEFAULT_QUOTATION_IS_UTF8 = false;
 template<typename T>
 std::string to_string_forward(const T& value);
 
+// Forward declaration for append-based output of reflected struct fields
+template<typename T>
+void append_quoted_if_needed(std::string& out, const T& value);
+
+// Forward declaration for append-based output of smart pointers, optional, variant and any
+template<typename T>
+void append_wrapped_value(std::string& out, const T& value, bool quote_strings);
+
+// Forward declaration for append-based output of ranges without cbegin/cend
+template<typename T>
+void append_plain_range(std::string& out, const T& range);
+
 // Optimized shared function to apply quotation if needed for any type
 // Uses template specialization to avoid runtime conditionals
 
@@ -398,6 +434,65 @@ inline const char* get_null_string() {
     return "null";
 }
 
+#if defined(USTR_FUNCTION_SIGNATURE_)
+// Signature of this function, which contains the name of T, e.g.
+// "const char* ustr::details::type_signature() [with T = Foo]"
+template<typename T>
+inline USTR_CONSTEXPR17_ const char* type_signature() {
+    return USTR_FUNCTION_SIGNATURE_;
+}
+
+// Position of the type name inside type_signature(), measured on a known type
+struct type_signature_layout {
+    std::size_t prefix;
+    std::size_t suffix;
+};
+
+#if __cplusplus >= 201703L
+inline constexpr type_signature_layout get_type_signature_layout() {
+    constexpr std::string_view probe = type_signature<int>();
+    return type_signature_layout{probe.find("int"), probe.size() - probe.find("int") - 3};
+}
+#else
+inline type_signature_layout get_type_signature_layout() {
+    const char* probe = type_signature<int>();
+    const std::size_t prefix = static_cast<std::size_t>(std::strstr(probe, "int") - probe);
+    type_signature_layout layout = {prefix, std::strlen(probe) - prefix - 3};
+    return layout;
+}
+#endif
+#endif // USTR_FUNCTION_SIGNATURE_
+
+// Name of T, extracted once per type from the function signature
+template<typename T>
+inline const std::string& type_name_impl() {
+#if defined(USTR_FUNCTION_SIGNATURE_)
+    static const std::string name = [] {
+        const type_signature_layout layout = get_type_signature_layout();
+        const char* signature = type_signature<T>();
+        const std::size_t length = std::strlen(signature);
+        return std::string(signature + layout.prefix, length - layout.prefix - layout.suffix);
+    }();
+#else
+    static const std::string name = typeid(T).name();
+#endif
+    return name;
+}
+
+// Appends value as lowercase hexadecimal with 0x prefix
+inline void append_hex(std::string& out, std::uintptr_t value) {
+    static const char digits[] = "0123456789abcdef";
+    char buffer[2 * sizeof(std::uintptr_t)];
+    char* const end = buffer + sizeof(buffer);
+    char* begin = end;
+    do {
+        *--begin = digits[value & 0xF];
+        value >>= 4;
+    } while (value != 0);
+    out += "0x";
+    out.append(begin, static_cast<std::size_t>(end - begin));
+}
+
 // Helper to detect if a type has first and second members (like std::pair)
 template<typename T, typename = void>
 struct has_first_second : std::false_type {};
@@ -424,6 +519,99 @@ struct is_tuple : std::false_type {};
 template<typename... Args>
 struct is_tuple<std::tuple<Args...>> : std::true_type {};
 
+// Helper to detect std::unique_ptr and std::shared_ptr to a single object
+template<typename T>
+struct is_smart_pointer : std::false_type {};
+
+template<typename T, typename D>
+struct is_smart_pointer<std::unique_ptr<T, D>>
+    : std::integral_constant<bool, !std::is_array<T>::value && !std::is_void<T>::value> {};
+
+template<typename T>
+struct is_smart_pointer<std::shared_ptr<T>>
+    : std::integral_constant<bool, !std::is_array<T>::value && !std::is_void<T>::value> {};
+
+// Helpers to detect C++17 vocabulary types (always false before C++17)
+template<typename T>
+struct is_optional : std::false_type {};
+
+template<typename T>
+struct is_variant : std::false_type {};
+
+template<typename T>
+struct is_monostate : std::false_type {};
+
+template<typename T>
+struct is_any : std::false_type {};
+
+#if __cplusplus >= 201703L
+template<typename T>
+struct is_optional<std::optional<T>> : std::true_type {};
+
+template<typename... Types>
+struct is_variant<std::variant<Types...>> : std::true_type {};
+
+template<>
+struct is_monostate<std::monostate> : std::true_type {};
+
+template<>
+struct is_any<std::any> : std::true_type {};
+#endif
+
+// Helper to detect ranges exposing begin()/end() (e.g. std::span, which has no cbegin/cend before C++23)
+template<typename T>
+struct has_begin_end {
+private:
+    template<typename U>
+    static auto test(int) -> decltype(
+        std::declval<const U&>().begin(),
+        std::declval<const U&>().end(),
+        std::true_type{}
+    );
+
+    template<typename>
+    static std::false_type test(...);
+
+public:
+    static const bool value = decltype(test<T>(0))::value;
+};
+
+// Helper to detect contiguous ranges exposing data()/size()
+template<typename T>
+struct has_data_size {
+private:
+    template<typename U>
+    static auto test(int) -> decltype(
+        *std::declval<const U&>().data(),
+        std::declval<const U&>().size(),
+        std::true_type{}
+    );
+
+    template<typename>
+    static std::false_type test(...);
+
+public:
+    static const bool value = decltype(test<T>(0))::value;
+};
+
+// Ranges without cbegin/cend, formatted like containers
+template<typename T>
+struct is_plain_range : std::integral_constant<bool,
+    !has_cbegin_cend<T>::value &&
+    (has_begin_end<T>::value || has_data_size<T>::value)
+> {};
+
+// Types holding at most one value, written as that value or null
+// (std::monostate, the empty alternative of a variant, is always null)
+template<typename T>
+struct is_value_wrapper : std::integral_constant<bool,
+    is_smart_pointer<T>::value ||
+    is_optional<T>::value ||
+    is_variant<T>::value ||
+    is_monostate<T>::value ||
+    is_any<T>::value
+> {};
+
 // C++11 compatible index sequence implementation
 template<std::size_t... Indices>
 struct index_sequence {};
@@ -474,6 +662,81 @@ struct is_special_type : std::integral_constant<bool,
 #endif
 > {};
 
+// Entry of the field table generated by USTR_REFLECT: field name and member pointer
+template<typename T, typename M>
+struct reflected_field {
+    const char* name;
+    M T::* member;
+
+    constexpr reflected_field(const char* field_name, M T::* field_member)
+        : name(field_name), member(field_member) {}
+};
+
+// Helper to detect types registered with USTR_REFLECT (found by argument-dependent lookup)
+template<typename T>
+struct is_reflectable {
+private:
+    template<typename U>
+    static auto test(int) -> decltype(
+        ustr_reflect_fields(static_cast<const U*>(nullptr)),
+        std::true_type{}
+    );
+
+    template<typename>
+    static std::false_type test(...);
+
+public:
+    static const bool value = decltype(test<T>(0))::value;
+};
+
+template<typename T, typename Visitor, typename Fields, std::size_t... Indices>
+inline void visit_reflected_fields_impl(const T& value, Visitor& visitor, const Fields& fields,
+                                        index_sequence<Indices...>) {
+    (void)std::initializer_list<int>{
+        (visitor(std::get<Indices>(fields).name, value.*(std::get<Indices>(fields).member)), 0)...};
+}
+
+// Calls visitor(name, field_value) for each field of a reflected struct, in declaration order
+template<typename T, typename Visitor>
+inline void visit_reflected_fields(const T& value, Visitor& visitor) {
+    typedef decltype(ustr_reflect_fields(static_cast<const T*>(nullptr))) fields_type;
+    const fields_type fields = ustr_reflect_fields(static_cast<const T*>(nullptr));
+    visit_reflected_fields_impl(value, visitor, fields,
+                                make_index_sequence<std::tuple_size<fields_type>::value>{});
+}
+
+template<typename Visitor, typename Fields, std::size_t... Indices>
+inline void visit_reflected_field_names_impl(Visitor& visitor, const Fields& fields,
+                                             index_sequence<Indices...>) {
+    (void)std::initializer_list<int>{(visitor(std::get<Indices>(fields).name), 0)...};
+}
+
+// Calls visitor(name) for each field of a reflected struct, without needing an instance
+template<typename T, typename Visitor>
+inline void visit_reflected_field_names(Visitor& visitor) {
+    typedef decltype(ustr_reflect_fields(static_cast<const T*>(nullptr))) fields_type;
+    const fields_type fields = ustr_reflect_fields(static_cast<const T*>(nullptr));
+    visit_reflected_field_names_impl(visitor, fields,
+                                     make_index_sequence<std::tuple_size<fields_type>::value>{});
+}
+
+// Writes reflected fields as name: value, quoting string values
+struct reflected_field_writer {
+    std::string& out;
+    bool first;
+
+    template<typename M>
+    void operator()(const char* name, const M& field_value) {
+        if (!first) {
+            out += ", ";
+        }
+        first = false;
+        out += name;
+        out += ": ";
+        append_quoted_if_needed(out, field_value);
+    }
+};
+
 // Implementation for types with custom to_string method (highest priority)
 template<typename T>
 inline auto to_string_impl(const T& value) 
@@ -551,6 +814,38 @@ inline auto to_string_impl(const T& value)
     return std::to_string(static_cast<typename std::underlying_type<T>::type>(value));
 }
 
+// Implementation for structs registered with USTR_REFLECT: {field1: value1, field2: value2}
+template<typename T>
+inline auto to_string_impl(const T& value)
+    -> typename std::enable_if<
+        is_reflectable<T>::value &&
+        !has_to_string<T>::value &&
+        !is_numeric<T>::value &&
+        !is_special_type<T>::value &&
+        !is_enum<T>::value,
+        std::string
+    >::type {
+    std::string out;
+    out += '{';
+    reflected_field_writer writer = {out, true};
+    visit_reflected_fields(value, writer);
+    out += '}';
+    return out;
+}
+
+// Implementation for smart pointers, std::optional, std::variant and std::any: contained value or null
+template<typename T>
+inline auto to_string_impl(const T& value)
+    -> typename std::enable_if<
+        is_value_wrapper<T>::value &&
+        !has_to_string<T>::value,
+        std::string
+    >::type {
+    std::string out;
+    append_wrapped_value(out, value, false);
+    return out;
+}
+
 // Implementation for std::pair types
 template<typename T>
 inline auto to_string_impl(const T& value)
@@ -592,6 +887,7 @@ inline auto to_string_impl(const T& value)
         !is_enum<T>::value &&
         !is_pair<T>::value &&
         !is_tuple<T>::value &&
+        !is_reflectable<T>::value &&
         !is_c_array<T>::value &&
         has_cbegin_cend<T>::value,
         std::string
@@ -599,7 +895,8 @@ inline auto to_string_impl(const T& value)
     return to_string(value.cbegin(), value.cend());
 }
 
-// Implementation for streamable types (excluding numeric, special types, enums, pairs, tuples, c-arrays, and containers with cbegin/cend)
+// Implementation for ranges exposing only begin()/end() or data()/size() (e.g. std::span).
+// Streamable types keep using operator<< so types like std::filesystem::path are not split.
 template<typename T>
 inline auto to_string_impl(const T& value)
     -> typename std::enable_if<
@@ -610,16 +907,18 @@ inline auto to_string_impl(const T& value)
         !is_pair<T>::value &&
         !is_tuple<T>::value &&
         !is_c_array<T>::value &&
-        !has_cbegin_cend<T>::value &&
-        is_streamable<T>::value, 
+        !is_reflectable<T>::value &&
+        !is_value_wrapper<T>::value &&
+        !is_streamable<T>::value &&
+        is_plain_range<T>::value,
         std::string
     >::type {
-    std::ostringstream ss;
-    ss << value;
-    return ss.str();
+    std::string out;
+    append_plain_range(out, value);
+    return out;
 }
 
-// Implementation for non-streamable types (fallback)
+// Implementation for streamable types (excluding numeric, special types, enums, pairs, tuples, c-arrays, and containers with cbegin/cend)
 template<typename T>
 inline auto to_string_impl(const T& value)
     -> typename std::enable_if<
@@ -630,16 +929,18 @@ inline auto to_string_impl(const T& value)
         !is_pair<T>::value &&
         !is_tuple<T>::value &&
         !is_c_array<T>::value &&
+        !is_reflectable<T>::value &&
+        !is_value_wrapper<T>::value &&
         !has_cbegin_cend<T>::value &&
-        !is_streamable<T>::value, 
+        is_streamable<T>::value, 
         std::string
     >::type {
     std::ostringstream ss;
-    ss << "[" << typeid(T).name() << " at " << &value << "]";
+    ss << value;
     return ss.str();
 }
 
-// Implementation for C-style arrays (excluding char arrays which are handled as C-strings)
+// Implementation for non-streamable types (fallback)
 template<typename T>
 inline auto to_string_impl(const T& value)
     -> typename std::enable_if<
@@ -649,9 +950,34 @@ inline auto to_string_impl(const T& value)
         !is_enum<T>::value &&
         !is_pair<T>::value &&
         !is_tuple<T>::value &&
-        is_c_array<T>::value,
+        !is_c_array<T>::value &&
+        !is_reflectable<T>::value &&
+        !is_value_wrapper<T>::value &&
+        !has_cbegin_cend<T>::value &&
+        !is_plain_range<T>::value &&
+        !is_streamable<T>::value, 
         std::string
     >::type {
+    const std::string& name = type_name_impl<T>();
+    std::string out;
+    // "[" + name + " at 0x" + address + "]"
+    out.reserve(name.size() + 2 * sizeof(std::uintptr_t) + 8);
+    out += '[';
+    out += name;
+    out += " at ";
+    append_hex(out, reinterpret_cast<std::uintptr_t>(std::addressof(value)));
+    out += ']';
+    return out;
+}
+
+// C-style array of numbers: formatted by the contiguous range fast path
+template<typename T>
+inline std::string c_array_to_string(const T& value, std::true_type /* numeric elements */) {
+    return to_string(std::begin(value), std::end(value));
+}
+
+template<typename T>
+inline std::string c_array_to_string(const T& value, std::false_type /* numeric elements */) {
     constexpr std::size_t array_size = std::extent<T>::value;
     std::ostringstream ss;
     ss << '[';
@@ -665,6 +991,24 @@ inline auto to_string_impl(const T& value)
     return ss.str();
 }
 
+// Implementation for C-style arrays (excluding char arrays which are handled as C-strings)
+template<typename T>
+inline auto to_string_impl(const T& value)
+    -> typename std::enable_if<
+        !has_to_string<T>::value && 
+        !is_numeric<T>::value && 
+        !is_special_type<T>::value &&
+        !is_enum<T>::value &&
+        !is_pair<T>::value &&
+        !is_tuple<T>::value &&
+        is_c_array<T>::value,
+        std::string
+    >::type {
+    typedef typename std::remove_extent<T>::type element_type;
+    return c_array_to_string(value, std::integral_constant<bool,
+        is_numeric<element_type>::value && !has_custom_specialization<element_type>::value>{});
+}
+
 /** @} */ // end of implementation group
 
 } // namespace details
@@ -683,11 +1027,14 @@ inline auto to_string_impl(const T& value)
  * 
  * 1. If the type has a to_string() method, use it
  * 2. If the type is numeric, use std::to_string()
- * 3. If the type is std::pair, format as (first, second)
- * 4. If the type is std::tuple, format as (elem1, elem2, ...)
- * 5. If the type has cbegin/cend methods (containers), use iterator-based conversion
- * 6. If the type is streamable, use operator<<
- * 7. Otherwise, return type information with memory address
+ * 3. If the type is registered with USTR_REFLECT, format as {field: value, ...}
+ * 4. If the type is a smart pointer, std::optional, std::variant or std::any,
+ *    format the contained value, or "null" when there is none
+ * 5. If the type is std::pair, format as (first, second)
+ * 6. If the type is std::tuple, format as (elem1, elem2, ...)
+ * 7. If the type has cbegin/cend methods (containers), use iterator-based conversion
+ * 8. If the type is streamable, use operator<<
+ * 9. Otherwise, return type information with memory address
  * 
  * Special handling for common types:
  * - std::string: returned as-is
@@ -740,131 +1087,2064 @@ namespace details {
     }
 }
 
-// Forward declarations for helper functions
-template<typename T>
-inline void add_iterator_value(std::ostringstream& ss, const T& value, std::false_type);
+namespace details {
+
+/**
+ * @defgroup append Append-Based Output
+ * @brief Helpers writing string representations directly into an output buffer
+ *
+ * These functions produce exactly the same text as ustr::to_string, but append
+ * it to an existing std::string instead of returning a temporary. Numeric and
+ * string types are written without intermediate allocations. Types marked with
+ * has_custom_specialization or providing to_string() always go through
+ * to_string_impl so user customizations are honored.
+ * @{
+ */
 
+// Types for which the built-in conversion (and therefore the fast path) applies
 template<typename T>
-inline void add_iterator_value(std::ostringstream& ss, const T& value, std::true_type);
+struct uses_builtin_conversion : std::integral_constant<bool,
+    !has_custom_specialization<T>::value &&
+    !has_to_string<T>::value
+> {};
 
-/**
- * @brief Convert a range defined by iterators to a string representation
- * 
- * This function converts a range of elements defined by iterators into
- * a comma-separated list surrounded by square brackets, e.g., [1, 2, 3].
- * For iterators pointing to key-value pairs (like those from std::map),
- * it uses a JSON-like format, e.g., {"key1": "value1", "key2": "value2"}.
- * 
- * @tparam IterT Type of the iterator
- * @param begin Begin iterator of the container
- * @param end End iterator of the container
- * @return String representation of the container contents
- * 
- * @code{.cpp}
- * // Vector example
- * std::vector<int> vec = {1, 2, 3};
- * auto s1 = ustr::to_string(vec.cbegin(), vec.cend());  // "[1, 2, 3]"
- * 
- * // Map example
- * std::map<std::string, int> map = {{"a", 1}, {"b", 2}};
- * auto s2 = ustr::to_string(map.cbegin(), map.cend());  // "{"a": 1, "b": 2}"
- * @endcode
- */ 
-template<typename IterT>
-inline std::string to_string(IterT begin, IterT end) {
-    // Check if we're dealing with a key-value pair container (like std::map)
-    using value_type = typename std::iterator_traits<IterT>::value_type;
-    
-    // Check for pair-like types (having first and second members)
-    using pair_check = typename details::has_first_second<value_type>;
-    const bool is_pair = pair_check::value;
-    
-    std::ostringstream ss;
-    if (is_pair) {
-        // Use JSON-like format for key-value pairs
-        ss << '{';
-    } else {
-        // Use array format for regular containers
-        ss << '[';
-    }
-    
-    bool first = true;
-    for (IterT it = begin; it != end; ++it) {
-        if (!first) {
-            ss << ", ";
-        } else {
-            first = false;
-        }
-        
-        // Use template specialization to handle the different types
-        add_iterator_value(ss, *it, typename details::has_first_second<value_type>::type());
+// Writes decimal digits of an unsigned value backwards, ending at buf_end.
+// Returns pointer to the first digit.
+template<typename U>
+inline char* format_unsigned_backwards(char* buf_end, U value) {
+    static const char digit_pairs[] =
+        "00010203040506070809"
+        "10111213141516171819"
+        "20212223242526272829"
+        "30313233343536373839"
+        "40414243444546474849"
+        "50515253545556575859"
+        "60616263646566676869"
+        "70717273747576777879"
+        "80818283848586878889"
+        "90919293949596979899";
+    char* p = buf_end;
+    while (value >= 100) {
+        const std::size_t idx = static_cast<std::size_t>(value % 100) * 2;
+        value = static_cast<U>(value / 100);
+        *--p = digit_pairs[idx + 1];
+        *--p = digit_pairs[idx];
     }
-    
-    if (is_pair) {
-        ss << '}';
+    if (value >= 10) {
+        const std::size_t idx = static_cast<std::size_t>(value) * 2;
+        *--p = digit_pairs[idx + 1];
+        *--p = digit_pairs[idx];
     } else {
-        ss << ']';
+        *--p = static_cast<char>('0' + static_cast<int>(value));
     }
-    
-    return ss.str();
+    return p;
 }
 
-// Helper function to add iterator value when it's not a pair
+// Maximum number of characters needed for any integer type (sign + digits)
+constexpr std::size_t MAX_INTEGER_CHARS = 41;
+
+// Writes an integer (with sign) backwards, ending at buf_end. Returns pointer to the first character.
 template<typename T>
-inline void add_iterator_value(std::ostringstream& ss, const T& value, std::false_type) {
-    // Use shared quotation function
-    ss << details::apply_quotation_if_needed(value);
+inline typename std::enable_if<std::is_signed<T>::value, char*>::type
+format_integer_backwards(char* buf_end, T value) {
+    typedef typename std::make_unsigned<T>::type unsigned_type;
+    const bool negative = value < 0;
+    const unsigned_type magnitude = negative
+        ? static_cast<unsigned_type>(0u - static_cast<unsigned_type>(value))
+        : static_cast<unsigned_type>(value);
+    char* begin = format_unsigned_backwards(buf_end, magnitude);
+    if (negative) {
+        *--begin = '-';
+    }
+    return begin;
 }
 
-// Helper function to add iterator value when it's a pair
 template<typename T>
-inline void add_iterator_value(std::ostringstream& ss, const T& value, std::true_type) {
-    // Use shared quotation function for both key and value
-    ss << details::apply_quotation_if_needed(value.first) << ": " << details::apply_quotation_if_needed(value.second);
+inline typename std::enable_if<!std::is_signed<T>::value, char*>::type
+format_integer_backwards(char* buf_end, T value) {
+    return format_unsigned_backwards(buf_end, value);
 }
 
-/** @} */ // end of api group
-
-/**
- * @defgroup formatters Local Scope Formatters
- * @brief Classes for customizing formatting within specific scopes
- * @{
- */
-
-/**
- * @brief Base class for custom formatters
- * 
- * Allows customization of how specific types are converted to strings
- * within a local scope, enabling different formatting rules for the
- * same types in different contexts.
- */
+// Integer kernel: same output as std::to_string, no allocation
 template<typename T>
-class formatter_base {
-public:
-    virtual ~formatter_base() = default;
-    virtual std::string format(const T& value) const = 0;
-};
+inline void append_integer(std::string& out, T value) {
+    char buf[MAX_INTEGER_CHARS];
+    char* end = buf + sizeof(buf);
+    char* begin = format_integer_backwards(end, value);
+    out.append(begin, static_cast<std::size_t>(end - begin));
+}
 
-/**
- * @brief Lambda-based formatter for easy inline customization
- * 
- * @tparam T Type to format
- * @tparam Func Function type (usually auto-deduced)
- */
-template<typename T, typename Func>
-class lambda_formatter : public formatter_base<T> {
-private:
-    Func func_;
-public:
-    explicit lambda_formatter(Func func) : func_(std::move(func)) {}
-    std::string format(const T& value) const override {
-        return func_(value);
+// Floating point kernel: same "%f" output as std::to_string, formatted on the stack
+inline void append_floating(std::string& out, double value) {
+    char buf[128];
+    const int n = std::snprintf(buf, sizeof(buf), "%f", value);
+    if (n > 0 && static_cast<std::size_t>(n) < sizeof(buf)) {
+        out.append(buf, static_cast<std::size_t>(n));
+    } else {
+        out += std::to_string(value);
     }
-};
+}
 
-/**
- * @brief Format context for local customization
- * 
+inline void append_floating(std::string& out, float value) {
+    append_floating(out, static_cast<double>(value));
+}
+
+inline void append_floating(std::string& out, long double value) {
+    char buf[128];
+    const int n = std::snprintf(buf, sizeof(buf), "%Lf", value);
+    if (n > 0 && static_cast<std::size_t>(n) < sizeof(buf)) {
+        out.append(buf, static_cast<std::size_t>(n));
+    } else {
+        out += std::to_string(value);
+    }
+}
+
+// Integer sequence kernel: the output is reserved once for the worst case, then
+// elements and separators are written in blocks straight into the buffer
+template<typename T>
+inline typename std::enable_if<std::is_integral<T>::value>::type
+append_numeric_sequence(std::string& out, const T* data, std::size_t size, const std::string& separator) {
+    const std::size_t block_size = 256;
+    const std::size_t max_element_chars =
+        static_cast<std::size_t>(std::numeric_limits<T>::digits10) + 2 + separator.size();
+    out.reserve(out.size() + size * max_element_chars);
+    std::size_t i = 0;
+    while (i < size) {
+        const std::size_t count = (size - i < block_size) ? size - i : block_size;
+        const std::size_t old_size = out.size();
+        out.resize(old_size + count * max_element_chars);
+        char* p = &out[old_size];
+        for (const std::size_t block_end = i + count; i < block_end; ++i) {
+            if (i != 0) {
+                std::memcpy(p, separator.data(), separator.size());
+                p += separator.size();
+            }
+            char buf[MAX_INTEGER_CHARS];
+            char* end = buf + sizeof(buf);
+            char* begin = format_integer_backwards(end, data[i]);
+            const std::size_t length = static_cast<std::size_t>(end - begin);
+            std::memcpy(p, begin, length);
+            p += length;
+        }
+        out.resize(static_cast<std::size_t>(p - out.data()));
+    }
+}
+
+// Floating point sequence kernel: one reservation, each element formatted on the stack
+template<typename T>
+inline typename std::enable_if<std::is_floating_point<T>::value>::type
+append_numeric_sequence(std::string& out, const T* data, std::size_t size, const std::string& separator) {
+    // "%f" gives at least 8 characters ("0.000000")
+    out.reserve(out.size() + size * (8 + separator.size()));
+    for (std::size_t i = 0; i < size; ++i) {
+        if (i != 0) {
+            out += separator;
+        }
+        append_floating(out, data[i]);
+    }
+}
+
+// Direct appends for special types (mirrors the to_string_impl overloads)
+inline void append_special(std::string& out, const std::string& value) {
+    out += value;
+}
+
+inline void append_special(std::string& out, const char* value) {
+    out += value ? value : get_null_string();
+}
+
+inline void append_special(std::string& out, bool value) {
+    out += value ? "true" : "false";
+}
+
+inline void append_special(std::string& out, char value) {
+    out += value;
+}
+
+inline void append_special(std::string& out, signed char value) {
+    out += static_cast<char>(value);
+}
+
+inline void append_special(std::string& out, unsigned char value) {
+    out += static_cast<char>(value);
+}
+
+inline void append_special(std::string& out, std::nullptr_t) {
+    out += get_null_string();
+}
+
+#if __cplusplus >= 201703L
+inline void append_special(std::string& out, std::string_view value) {
+    out.append(value.data(), value.size());
+}
+#endif
+
+// Length of the UTF-8 sequence starting at s[i] (which is >= 0x80), cut short
+// at the first byte that is not a continuation byte so malformed input cannot
+// hide a following ASCII delimiter.
+inline std::size_t utf8_sequence_length(const char* s, std::size_t i, std::size_t length) {
+    unsigned char c = static_cast<unsigned char>(s[i]);
+    std::size_t byte_count = 1;
+    if ((c & 0xE0) == 0xC0) byte_count = 2;      // 110xxxxx
+    else if ((c & 0xF0) == 0xE0) byte_count = 3; // 1110xxxx
+    else if ((c & 0xF8) == 0xF0) byte_count = 4; // 11110xxx
+
+    std::size_t n = 1;
+    while (n < byte_count && i + n < length &&
+           (static_cast<unsigned char>(s[i + n]) & 0xC0) == 0x80) {
+        ++n;
+    }
+    return n;
+}
+
+// Quoting kernel shared by quoted_str and container formatting.
+// Skips a leading UTF-8 BOM, escapes delimiters and the escape character.
+inline void append_quoted(std::string& out, const char* s, std::size_t length,
+                          char start_delim, char end_delim, char escape, bool is_utf8) {
+    // Estimate capacity: original size + 2 delimiters + potential escapes
+    // We use a conservative estimate of 25% potential escapes
+    out.reserve(out.size() + length + 2 + (length / 4));
+    
+    // Add opening delimiter
+    out += start_delim;
+    
+    // Skip BOM if present at the beginning
+    std::size_t start_pos = 0;
+    if (length >= 3 && 
+        static_cast<unsigned char>(s[0]) == 0xEF && 
+        static_cast<unsigned char>(s[1]) == 0xBB && 
+        static_cast<unsigned char>(s[2]) == 0xBF) {
+        // UTF-8 BOM detected, skip it
+        start_pos = 3;
+    }
+    
+    if (escape != '\0') {
+        // Escape mode: scan for start_delim, end_delim, and escape characters
+        if (is_utf8) {
+            // UTF-8 aware mode: handle multi-byte characters
+            for (std::size_t i = start_pos; i < length; ) {
+                unsigned char c = static_cast<unsigned char>(s[i]);
+                
+                // Check if this is a UTF-8 multi-byte character
+                if (c >= 0x80) {
+                    // Add the entire UTF-8 sequence
+                    std::size_t byte_count = utf8_sequence_length(s, i, length);
+                    out.append(s + i, byte_count);
+                    i += byte_count;
+                } else {
+                    // ASCII character - check if it needs escaping
+                    char ch = static_cast<char>(c);
+                    if (ch == start_delim || ch == end_delim || ch == escape) {
+                        out += escape;
+                    }
+                    out += ch;
+                    ++i;
+                }
+            }
+        } else {
+            // ASCII-only mode: copy runs of plain bytes, escape special ones
+            std::size_t run_start = start_pos;
+            for (std::size_t i = start_pos; i < length; ++i) {
+                char ch = s[i];
+                if (ch == start_delim || ch == end_delim || ch == escape) {
+                    out.append(s + run_start, i - run_start);
+                    out += escape;
+                    run_start = i;
+                }
+            }
+            out.append(s + run_start, length - run_start);
+        }
+    } else {
+        // No escaping: just add all characters (but skip BOM)
+        out.append(s + start_pos, length - start_pos);
+    }
+    
+    // Add closing delimiter
+    out += end_delim;
+}
+
+// Inverse of append_quoted: appends the content of a quoted string with escapes removed.
+// Returns false when a delimiter is missing or unescaped, an escape is dangling
+// or characters follow the closing delimiter.
+inline bool append_unquoted(std::string& out, const char* s, std::size_t length,
+                            char start_delim, char end_delim, char escape, bool is_utf8) {
+    if (length < 2 || s[0] != start_delim) {
+        return false;
+    }
+
+    if (escape == '\0') {
+        // No escaping: the content is everything between the delimiters
+        if (s[length - 1] != end_delim) {
+            return false;
+        }
+        out.append(s + 1, length - 2);
+        return true;
+    }
+
+    std::size_t run_start = 1;
+    for (std::size_t i = 1; i < length; ++i) {
+        if (is_utf8 && static_cast<unsigned char>(s[i]) >= 0x80) {
+            // Multi-byte characters are copied as they are, never escaped
+            i += utf8_sequence_length(s, i, length) - 1;
+            continue;
+        }
+        char ch = s[i];
+        bool is_last = (i + 1 == length);
+        if (ch == escape && !(ch == end_delim && is_last)) {
+            if (is_last) {
+                return false;
+            }
+            out.append(s + run_start, i - run_start);
+            run_start = ++i;
+        } else if (ch == end_delim) {
+            if (!is_last) {
+                return false;
+            }
+            out.append(s + run_start, i - run_start);
+            return true;
+        } else if (ch == start_delim) {
+            return false;
+        }
+    }
+    return false;
+}
+
+// Default quoting of string values (as used for container elements)
+inline void append_quoted_string(std::string& out, const char* s, std::size_t length) {
+    append_quoted(out, s, length,
+                  DEFAULT_QUOTATION_DELIMITER,
+                  DEFAULT_QUOTATION_DELIMITER,
+                  DEFAULT_QUOTATION_ESCAPE_CHAR,
+                  DEFAULT_QUOTATION_IS_UTF8);
+}
+
+inline void append_quoted_special(std::string& out, const std::string& value) {
+    append_quoted_string(out, value.data(), value.size());
+}
+
+inline void append_quoted_special(std::string& out, const char* value) {
+    const char* s = value ? value : get_null_string();
+    append_quoted_string(out, s, std::char_traits<char>::length(s));
+}
+
+#if __cplusplus >= 201703L
+inline void append_quoted_special(std::string& out, std::string_view value) {
+    append_quoted_string(out, value.data(), value.size());
+}
+#endif
+
+// Quotable strings using the built-in conversion are quoted in place
+template<typename T>
+inline auto append_quoted_impl(std::string& out, const T& value, std::true_type)
+    -> typename std::enable_if<uses_builtin_conversion<T>::value>::type {
+    append_quoted_special(out, value);
+}
+
+// Quotable strings with a custom conversion are quoted after conversion
+template<typename T>
+inline auto append_quoted_impl(std::string& out, const T& value, std::true_type)
+    -> typename std::enable_if<!uses_builtin_conversion<T>::value>::type {
+    const std::string s = to_string_forward(value);
+    append_quoted_string(out, s.data(), s.size());
+}
+
+template<typename T>
+inline void append_quoted_impl(std::string& out, const T& value, std::false_type);
+
+// Append-based counterpart of apply_quotation_if_needed
+template<typename T>
+inline void append_quoted_if_needed(std::string& out, const T& value) {
+    using value_type = typename std::decay<T>::type;
+    append_quoted_impl(out, value, typename is_quotable_string<value_type>::type{});
+}
+
+// Integral numeric types
+template<typename T>
+inline auto append_value(std::string& out, const T& value)
+    -> typename std::enable_if<
+        uses_builtin_conversion<T>::value &&
+        is_numeric<T>::value &&
+        std::is_integral<T>::value
+    >::type {
+    append_integer(out, value);
+}
+
+// Floating point types
+template<typename T>
+inline auto append_value(std::string& out, const T& value)
+    -> typename std::enable_if<
+        uses_builtin_conversion<T>::value &&
+        std::is_floating_point<T>::value
+    >::type {
+    append_floating(out, value);
+}
+
+// Strings, characters, bool and nullptr
+template<typename T>
+inline auto append_value(std::string& out, const T& value)
+    -> typename std::enable_if<
+        uses_builtin_conversion<T>::value &&
+        is_special_type<T>::value
+    >::type {
+    append_special(out, value);
+}
+
+// Smart pointers, optional, variant and any: contained value written in place
+template<typename T>
+inline auto append_value(std::string& out, const T& value)
+    -> typename std::enable_if<
+        uses_builtin_conversion<T>::value &&
+        is_value_wrapper<T>::value
+    >::type {
+    append_wrapped_value(out, value, false);
+}
+
+// Everything else goes through the regular to_string dispatch
+template<typename T>
+inline auto append_value(std::string& out, const T& value)
+    -> typename std::enable_if<
+        !(uses_builtin_conversion<T>::value &&
+          (is_numeric<T>::value || is_special_type<T>::value || is_value_wrapper<T>::value))
+    >::type {
+    out += to_string_forward(value);
+}
+
+template<typename T>
+inline void append_unquoted_element(std::string& out, const T& value, std::false_type /* value wrapper */) {
+    append_value(out, value);
+}
+
+// Wrappers quote a contained string like a plain string element
+template<typename T>
+inline void append_unquoted_element(std::string& out, const T& value, std::true_type /* value wrapper */) {
+    append_wrapped_value(out, value, true);
+}
+
+// Non-quotable values are appended as-is
+template<typename T>
+inline void append_quoted_impl(std::string& out, const T& value, std::false_type) {
+    append_unquoted_element(out, value, std::integral_constant<bool,
+        uses_builtin_conversion<T>::value && is_value_wrapper<T>::value>{});
+}
+
+template<typename T>
+inline void append_contained_value(std::string& out, const T& value, bool quote_strings) {
+    if (quote_strings) {
+        append_quoted_if_needed(out, value);
+    } else {
+        append_value(out, value);
+    }
+}
+
+template<typename T, typename D>
+inline void append_wrapped(std::string& out, const std::unique_ptr<T, D>& value, bool quote_strings) {
+    if (value) {
+        append_contained_value(out, *value, quote_strings);
+    } else {
+        out += get_null_string();
+    }
+}
+
+template<typename T>
+inline void append_wrapped(std::string& out, const std::shared_ptr<T>& value, bool quote_strings) {
+    if (value) {
+        append_contained_value(out, *value, quote_strings);
+    } else {
+        out += get_null_string();
+    }
+}
+
+#if __cplusplus >= 201703L
+template<typename T>
+inline void append_wrapped(std::string& out, const std::optional<T>& value, bool quote_strings) {
+    if (value) {
+        append_contained_value(out, *value, quote_strings);
+    } else {
+        out += get_null_string();
+    }
+}
+
+// Active alternative of a variant; valueless variants are written as null
+template<typename... Types>
+inline void append_wrapped(std::string& out, const std::variant<Types...>& value, bool quote_strings) {
+    if (value.valueless_by_exception()) {
+        out += get_null_string();
+        return;
+    }
+    std::visit([&out, quote_strings](const auto& alternative) {
+        append_contained_value(out, alternative, quote_strings);
+    }, value);
+}
+
+inline void append_wrapped(std::string& out, const std::monostate&, bool) {
+    out += get_null_string();
+}
+
+template<typename T>
+inline bool append_any_as(std::string& out, const std::any& value, bool quote_strings) {
+    if (const T* contained = std::any_cast<T>(&value)) {
+        append_contained_value(out, *contained, quote_strings);
+        return true;
+    }
+    return false;
+}
+
+// The contained type of std::any is only known at run time: common types are
+// written as values, other types as [any]
+inline void append_wrapped(std::string& out, const std::any& value, bool quote_strings) {
+    if (!value.has_value()) {
+        out += get_null_string();
+        return;
+    }
+    const bool written =
+        append_any_as<int>(out, value, quote_strings) ||
+        append_any_as<long>(out, value, quote_strings) ||
+        append_any_as<long long>(out, value, quote_strings) ||
+        append_any_as<unsigned int>(out, value, quote_strings) ||
+        append_any_as<unsigned long>(out, value, quote_strings) ||
+        append_any_as<unsigned long long>(out, value, quote_strings) ||
+        append_any_as<double>(out, value, quote_strings) ||
+        append_any_as<float>(out, value, quote_strings) ||
+        append_any_as<bool>(out, value, quote_strings) ||
+        append_any_as<char>(out, value, quote_strings) ||
+        append_any_as<std::string>(out, value, quote_strings) ||
+        append_any_as<const char*>(out, value, quote_strings) ||
+        append_any_as<std::string_view>(out, value, quote_strings);
+    if (!written) {
+        out += "[any]";
+    }
+}
+#endif
+
+template<typename T>
+inline void append_wrapped_value(std::string& out, const T& value, bool quote_strings) {
+    append_wrapped(out, value, quote_strings);
+}
+
+/** @} */ // end of append group
+
+} // namespace details
+
+/**
+ * @brief Append string representation of a value to an existing string
+ *
+ * Produces the same text as ustr::to_string(value) but writes it directly
+ * to the end of @p out, avoiding a temporary string for numeric, boolean,
+ * character and string values.
+ *
+ * @tparam T Type of the value to convert
+ * @param out Output string to append to
+ * @param value Value to convert
+ * @return Reference to @p out
+ *
+ * @code{.cpp}
+ * std::string line = "count=";
+ * ustr::append_to(line, 42);      // "count=42"
+ * @endcode
+ */
+template<typename T>
+inline std::string& append_to(std::string& out, const T& value) {
+    details::append_value(out, value);
+    return out;
+}
+
+/**
+ * @defgroup format Format Strings
+ * @brief Placeholder-based formatting with compile-time checked format strings
+ *
+ * Format strings use "{}" placeholders which are replaced, in order, by the
+ * string representation of the arguments (the same as ustr::to_string).
+ * Literal braces are written as "{{" and "}}".
+ *
+ * The format string is validated at compile time: malformed braces or a
+ * mismatch between the number of placeholders and arguments is a compilation
+ * error. With C++20, ustr::format() checks the literal in a consteval
+ * constructor and records placeholder offsets so no parsing happens at
+ * runtime. For earlier standards use the USTR_FORMAT macro.
+ * @{
+ */
+
+namespace details {
+
+// Marker returned by format string validation for malformed braces
+constexpr std::size_t FORMAT_STRING_INVALID = static_cast<std::size_t>(-1);
+
+#if __cplusplus >= 201402L
+// Counts "{}" placeholders, returns FORMAT_STRING_INVALID for malformed braces
+constexpr std::size_t count_format_placeholders(const char* s) {
+    std::size_t count = 0;
+    for (std::size_t i = 0; s[i] != '\0'; ++i) {
+        if (s[i] == '{') {
+            if (s[i + 1] == '{') {
+                ++i;
+            } else if (s[i + 1] == '}') {
+                ++count;
+                ++i;
+            } else {
+                return FORMAT_STRING_INVALID;
+            }
+        } else if (s[i] == '}') {
+            if (s[i + 1] != '}') {
+                return FORMAT_STRING_INVALID;
+            }
+            ++i;
+        }
+    }
+    return count;
+}
+#else
+// C++11 constexpr version (recursive, so limited by the compiler's constexpr depth)
+constexpr std::size_t count_format_placeholders(const char* s, std::size_t count = 0) {
+    return *s == '\0' ? count :
+        *s == '{' ? (s[1] == '{' ? count_format_placeholders(s + 2, count) :
+                     s[1] == '}' ? count_format_placeholders(s + 2, count + 1) :
+                     FORMAT_STRING_INVALID) :
+        *s == '}' ? (s[1] == '}' ? count_format_placeholders(s + 2, count) :
+                     FORMAT_STRING_INVALID) :
+        count_format_placeholders(s + 1, count);
+}
+#endif
+
+// Appends a literal segment of a validated format string, collapsing "{{" and "}}"
+inline void append_format_literal(std::string& out, const char* begin, const char* end) {
+    const char* p = begin;
+    while (p != end) {
+        if ((*p == '{' || *p == '}') && p + 1 != end && p[1] == *p) {
+            out.append(begin, static_cast<std::size_t>(p + 1 - begin));
+            p += 2;
+            begin = p;
+        } else {
+            ++p;
+        }
+    }
+    out.append(begin, static_cast<std::size_t>(end - begin));
+}
+
+// Runtime walk of a format string already validated at compile time
+class format_cursor {
+private:
+    const char* pos_;
+    const char* end_;
+
+public:
+    format_cursor(const char* str, std::size_t size) : pos_(str), end_(str + size) {}
+
+    // Appends literal text up to the next placeholder and skips the placeholder
+    void append_until_placeholder(std::string& out) {
+        const char* p = pos_;
+        while (p != end_) {
+            if (*p == '{' && p[1] == '}') {
+                append_format_literal(out, pos_, p);
+                pos_ = p + 2;
+                return;
+            }
+            p += (*p == '{' || *p == '}') ? 2 : 1;
+        }
+        append_format_literal(out, pos_, end_);
+        pos_ = end_;
+    }
+
+    void append_rest(std::string& out) {
+        append_format_literal(out, pos_, end_);
+        pos_ = end_;
+    }
+};
+
+// Rough per-argument capacity estimate for the output buffer
+constexpr std::size_t FORMAT_ARG_SIZE_HINT = 8;
+
+template<std::size_t Placeholders, std::size_t N, typename... Args>
+inline std::string format_checked(const char (&fmt)[N], const Args&... args) {
+    static_assert(Placeholders != FORMAT_STRING_INVALID,
+                  "ustr: invalid format string, use {} for placeholders and {{ }} for literal braces");
+    static_assert(Placeholders == sizeof...(Args),
+                  "ustr: number of {} placeholders does not match number of arguments");
+    std::string out;
+    out.reserve(N + sizeof...(Args) * FORMAT_ARG_SIZE_HINT);
+    format_cursor cursor(fmt, N - 1);
+    (void)std::initializer_list<int>{(cursor.append_until_placeholder(out), append_value(out, args), 0)...};
+    cursor.append_rest(out);
+    return out;
+}
+
+} // namespace details
+
+#if __cplusplus >= 202002L && defined(__cpp_consteval)
+namespace details {
+// Not constexpr on purpose: calling it from the consteval constructor
+// turns a bad format string into a compilation error naming the problem.
+inline void format_string_has_invalid_braces() {}
+inline void format_argument_count_does_not_match_placeholders() {}
+} // namespace details
+
+/**
+ * @brief Format string checked and pre-parsed at compile time (C++20)
+ *
+ * Constructed implicitly from a string literal when calling ustr::format().
+ * The consteval constructor validates braces, verifies that the number of
+ * placeholders equals the number of arguments and stores placeholder offsets,
+ * so formatting only copies literal segments and arguments.
+ *
+ * @tparam Args Types of the format arguments
+ */
+template<typename... Args>
+class basic_format_string {
+private:
+    static constexpr std::size_t arg_count = sizeof...(Args);
+
+    const char* str_;
+    std::size_t size_;
+    std::size_t placeholders_[arg_count + 1];
+    bool has_escapes_;
+
+public:
+    template<std::size_t N>
+    consteval basic_format_string(const char (&str)[N])
+        : str_(str), size_(N - 1), placeholders_{}, has_escapes_(false) {
+        std::size_t count = 0;
+        for (std::size_t i = 0; i < size_; ++i) {
+            if (str[i] == '{' && i + 1 < size_ && str[i + 1] == '}') {
+                if (count < arg_count) {
+                    placeholders_[count] = i;
+                }
+                ++count;
+                ++i;
+            } else if ((str[i] == '{' || str[i] == '}') && i + 1 < size_ && str[i + 1] == str[i]) {
+                has_escapes_ = true;
+                ++i;
+            } else if (str[i] == '{' || str[i] == '}') {
+                details::format_string_has_invalid_braces();
+            }
+        }
+        if (count != arg_count) {
+            details::format_argument_count_does_not_match_placeholders();
+        }
+        placeholders_[arg_count] = size_;
+    }
+
+    constexpr const char* data() const { return str_; }
+    constexpr std::size_t size() const { return size_; }
+
+    /// Offset of the i-th placeholder; index arg_count yields the string size
+    constexpr std::size_t placeholder(std::size_t i) const { return placeholders_[i]; }
+
+    constexpr bool has_escapes() const { return has_escapes_; }
+};
+
+/// Format string type deduced from the format() arguments
+template<typename... Args>
+using format_string = basic_format_string<std::type_identity_t<Args>...>;
+
+namespace details {
+
+template<typename... Args>
+inline void append_format_segment(std::string& out, const basic_format_string<Args...>& fmt,
+                                  std::size_t begin, std::size_t end) {
+    if (fmt.has_escapes()) {
+        append_format_literal(out, fmt.data() + begin, fmt.data() + end);
+    } else {
+        out.append(fmt.data() + begin, end - begin);
+    }
+}
+
+template<typename... Args, std::size_t... Indices>
+inline void format_to_impl(std::string& out, const basic_format_string<Args...>& fmt,
+                           index_sequence<Indices...>, const Args&... args) {
+    std::size_t pos = 0;
+    (void)std::initializer_list<int>{(
+        append_format_segment(out, fmt, pos, fmt.placeholder(Indices)),
+        append_value(out, args),
+        pos = fmt.placeholder(Indices) + 2,
+        0)...};
+    append_format_segment(out, fmt, pos, fmt.size());
+}
+
+} // namespace details
+
+/**
+ * @brief Append formatted text to an existing string (C++20)
+ *
+ * @param out Output string to append to
+ * @param fmt Format string literal with {} placeholders
+ * @param args Values substituted for the placeholders
+ * @return Reference to @p out
+ */
+template<typename... Args>
+inline std::string& format_to(std::string& out, format_string<Args...> fmt, const Args&... args) {
+    details::format_to_impl(out, fmt, details::make_index_sequence<sizeof...(Args)>{}, args...);
+    return out;
+}
+
+/**
+ * @brief Format values into a new string using {} placeholders (C++20)
+ *
+ * @code{.cpp}
+ * auto s = ustr::format("{} -> {}", 1, "one");   // "1 -> one"
+ * auto e = ustr::format("{{{}}}", 42);           // "{42}"
+ * // ustr::format("{} {}", 1);                   // compilation error
+ * @endcode
+ */
+template<typename... Args>
+inline std::string format(format_string<Args...> fmt, const Args&... args) {
+    std::string out;
+    out.reserve(fmt.size() + sizeof...(Args) * details::FORMAT_ARG_SIZE_HINT);
+    ::ustr::format_to(out, fmt, args...);
+    return out;
+}
+#endif // C++20
+
+/** @} */ // end of format group
+
+/**
+ * @brief Format values using {} placeholders, checked at compile time (C++11 and later)
+ *
+ * The first argument must be a string literal. The number of placeholders is
+ * computed by a constexpr function and verified with static_assert.
+ *
+ * @code{.cpp}
+ * std::string s = USTR_FORMAT("{} -> {}", 1, 2.5);   // "1 -> 2.500000"
+ * @endcode
+ */
+#define USTR_FORMAT(...) \
+    ::ustr::details::format_checked< \
+        ::ustr::details::count_format_placeholders(USTR_FORMAT_FIRST_ARG_(__VA_ARGS__, ~))>(__VA_ARGS__)
+#define USTR_FORMAT_FIRST_ARG_(first, ...) first
+
+/**
+ * @brief Register the fields of a struct for string conversion
+ *
+ * Generates a field table (names and member pointers) found by argument-dependent
+ * lookup, so it must be used in the namespace of the type, after its definition.
+ * From C++14 the table is constexpr; in C++11 std::tuple cannot be built in a
+ * constant expression, so the function is a plain inline one there.
+ * Reflected types are converted field by field with the regular dispatch:
+ * to_string gives {field: value, ...}, and to_logfmt writes field=value pairs.
+ * Up to 16 public fields are supported.
+ *
+ * @code{.cpp}
+ * struct Point { int x; int y; std::string label; };
+ * USTR_REFLECT(Point, x, y, label)
+ *
+ * ustr::to_string(Point{1, 2, "a"});   // {x: 1, y: 2, label: "a"}
+ * @endcode
+ */
+#define USTR_REFLECT(Type, ...) \
+    USTR_REFLECT_CONSTEXPR_ auto ustr_reflect_fields(const Type*) \
+        -> decltype(std::make_tuple(USTR_REFLECT_TABLE_(Type, __VA_ARGS__))) { \
+        typedef decltype(std::make_tuple(USTR_REFLECT_TABLE_(Type, __VA_ARGS__))) ustr_fields_type; \
+        return ustr_fields_type(USTR_REFLECT_TABLE_(Type, __VA_ARGS__)); \
+    }
+
+#if __cplusplus >= 201402L
+#define USTR_REFLECT_CONSTEXPR_ constexpr
+#else
+#define USTR_REFLECT_CONSTEXPR_ inline
+#endif
+
+#define USTR_EXPAND_(x) x
+#define USTR_CONCAT_(a, b) USTR_CONCAT_IMPL_(a, b)
+#define USTR_CONCAT_IMPL_(a, b) a##b
+#define USTR_COUNT_ARGS_(...) \
+    USTR_EXPAND_(USTR_COUNT_ARGS_IMPL_(__VA_ARGS__, 16, 15, 14, 13, 12, 11, 10, 9, 8, 7, 6, 5, 4, 3, 2, 1, 0))
+#define USTR_COUNT_ARGS_IMPL_(_1, _2, _3, _4, _5, _6, _7, _8, _9, _10, _11, _12, _13, _14, _15, _16, N, ...) N
+#define USTR_REFLECT_TABLE_(Type, ...) \
+    USTR_EXPAND_(USTR_CONCAT_(USTR_REFLECT_FIELDS_, USTR_COUNT_ARGS_(__VA_ARGS__))(Type, __VA_ARGS__))
+#define USTR_REFLECT_FIELD_(Type, field) \
+    ::ustr::details::reflected_field<Type, decltype(Type::field)>(#field, &Type::field)
+#define USTR_REFLECT_FIELDS_1(T, f) USTR_REFLECT_FIELD_(T, f)
+#define USTR_REFLECT_FIELDS_2(T, f, ...) USTR_REFLECT_FIELD_(T, f), USTR_EXPAND_(USTR_REFLECT_FIELDS_1(T, __VA_ARGS__))
+#define USTR_REFLECT_FIELDS_3(T, f, ...) USTR_REFLECT_FIELD_(T, f), USTR_EXPAND_(USTR_REFLECT_FIELDS_2(T, __VA_ARGS__))
+#define USTR_REFLECT_FIELDS_4(T, f, ...) USTR_REFLECT_FIELD_(T, f), USTR_EXPAND_(USTR_REFLECT_FIELDS_3(T, __VA_ARGS__))
+#define USTR_REFLECT_FIELDS_5(T, f, ...) USTR_REFLECT_FIELD_(T, f), USTR_EXPAND_(USTR_REFLECT_FIELDS_4(T, __VA_ARGS__))
+#define USTR_REFLECT_FIELDS_6(T, f, ...) USTR_REFLECT_FIELD_(T, f), USTR_EXPAND_(USTR_REFLECT_FIELDS_5(T, __VA_ARGS__))
+#define USTR_REFLECT_FIELDS_7(T, f, ...) USTR_REFLECT_FIELD_(T, f), USTR_EXPAND_(USTR_REFLECT_FIELDS_6(T, __VA_ARGS__))
+#define USTR_REFLECT_FIELDS_8(T, f, ...) USTR_REFLECT_FIELD_(T, f), USTR_EXPAND_(USTR_REFLECT_FIELDS_7(T, __VA_ARGS__))
+#define USTR_REFLECT_FIELDS_9(T, f, ...) USTR_REFLECT_FIELD_(T, f), USTR_EXPAND_(USTR_REFLECT_FIELDS_8(T, __VA_ARGS__))
+#define USTR_REFLECT_FIELDS_10(T, f, ...) USTR_REFLECT_FIELD_(T, f), USTR_EXPAND_(USTR_REFLECT_FIELDS_9(T, __VA_ARGS__))
+#define USTR_REFLECT_FIELDS_11(T, f, ...) USTR_REFLECT_FIELD_(T, f), USTR_EXPAND_(USTR_REFLECT_FIELDS_10(T, __VA_ARGS__))
+#define USTR_REFLECT_FIELDS_12(T, f, ...) USTR_REFLECT_FIELD_(T, f), USTR_EXPAND_(USTR_REFLECT_FIELDS_11(T, __VA_ARGS__))
+#define USTR_REFLECT_FIELDS_13(T, f, ...) USTR_REFLECT_FIELD_(T, f), USTR_EXPAND_(USTR_REFLECT_FIELDS_12(T, __VA_ARGS__))
+#define USTR_REFLECT_FIELDS_14(T, f, ...) USTR_REFLECT_FIELD_(T, f), USTR_EXPAND_(USTR_REFLECT_FIELDS_13(T, __VA_ARGS__))
+#define USTR_REFLECT_FIELDS_15(T, f, ...) USTR_REFLECT_FIELD_(T, f), USTR_EXPAND_(USTR_REFLECT_FIELDS_14(T, __VA_ARGS__))
+#define USTR_REFLECT_FIELDS_16(T, f, ...) USTR_REFLECT_FIELD_(T, f), USTR_EXPAND_(USTR_REFLECT_FIELDS_15(T, __VA_ARGS__))
+
+/**
+ * @brief Delimiters used when serializing a range of values
+ *
+ * Describes how ranges are written: separator between elements, opening and
+ * closing delimiters, separator between key and value of pair-like elements
+ * (e.g. std::map entries) and whether string elements are quoted.
+ * Used by ustr::join() and format_context range options; delimiters are
+ * written during the single serialization pass, so no post-processing is needed.
+ *
+ * @code{.cpp}
+ * ustr::range_format csv(",", "", "");                 // 1,2,3
+ * ustr::range_format labels(",", "{", "}", "=");       // {a="x",b="y"}
+ * @endcode
+ */
+struct range_format {
+    std::string separator;              ///< Written between elements
+    std::string open;                   ///< Written before the first element
+    std::string close;                  ///< Written after the last element
+    std::string key_value_separator;    ///< Written between first and second of pair-like elements
+    bool quote_strings;                 ///< Quote string elements as ustr::quoted_str does
+
+    range_format(std::string sep = ", ",
+                 std::string open_delim = "[",
+                 std::string close_delim = "]",
+                 std::string kv_sep = ": ",
+                 bool quote = true)
+        : separator(std::move(sep)),
+          open(std::move(open_delim)),
+          close(std::move(close_delim)),
+          key_value_separator(std::move(kv_sep)),
+          quote_strings(quote) {}
+};
+
+namespace details {
+
+// Default format for sequence containers: [1, 2, 3]
+inline const range_format& default_sequence_format() {
+    static const range_format format(", ", "[", "]", ": ", true);
+    return format;
+}
+
+// Default format for containers of pair-like elements: {"a": 1, "b": 2}
+inline const range_format& default_map_format() {
+    static const range_format format(", ", "{", "}", ": ", true);
+    return format;
+}
+
+// Default format selected by element type
+template<typename ValueT>
+inline const range_format& default_range_format() {
+    return has_first_second<ValueT>::value ? default_map_format() : default_sequence_format();
+}
+
+template<typename T>
+inline void append_range_item(std::string& out, const T& value, bool quote_strings) {
+    if (quote_strings) {
+        append_quoted_if_needed(out, value);
+    } else {
+        append_value(out, value);
+    }
+}
+
+// Regular element
+template<typename T>
+inline void append_range_element(std::string& out, const T& value, const range_format& format, std::false_type) {
+    append_range_item(out, value, format.quote_strings);
+}
+
+// Pair-like element: key, separator, value
+template<typename T>
+inline void append_range_element(std::string& out, const T& value, const range_format& format, std::true_type) {
+    append_range_item(out, value.first, format.quote_strings);
+    out += format.key_value_separator;
+    append_range_item(out, value.second, format.quote_strings);
+}
+
+// Contiguous range of numbers: formatted by the sequence kernels in a pointer loop
+template<typename T>
+inline void append_numeric_array(std::string& out, const T* data, std::size_t size, const range_format& format) {
+    out += format.open;
+    append_numeric_sequence(out, data, size, format.separator);
+    out += format.close;
+}
+
+// Helper to detect iterators over contiguous storage of numbers
+// (pointers, std::vector and, in C++20, any std::contiguous_iterator)
+template<typename IterT,
+         typename ValueT = typename std::iterator_traits<IterT>::value_type,
+         bool Numeric = is_numeric<ValueT>::value && uses_builtin_conversion<ValueT>::value>
+struct is_contiguous_numeric_iterator : std::false_type {};
+
+template<typename IterT, typename ValueT>
+struct is_contiguous_numeric_iterator<IterT, ValueT, true> : std::integral_constant<bool,
+    std::is_pointer<IterT>::value ||
+    std::is_same<IterT, typename std::vector<ValueT>::iterator>::value ||
+    std::is_same<IterT, typename std::vector<ValueT>::const_iterator>::value
+#if __cplusplus >= 202002L && defined(__cpp_lib_concepts)
+    || std::contiguous_iterator<IterT>
+#endif
+> {};
+
+template<typename IterT>
+inline void append_range_impl(std::string& out, IterT begin, IterT end, const range_format& format, std::true_type) {
+    if (begin == end) {
+        out += format.open;
+        out += format.close;
+        return;
+    }
+    append_numeric_array(out, std::addressof(*begin), static_cast<std::size_t>(std::distance(begin, end)), format);
+}
+
+template<typename IterT>
+inline void append_range_impl(std::string& out, IterT begin, IterT end, const range_format& format, std::false_type) {
+    using value_type = typename std::iterator_traits<IterT>::value_type;
+    out += format.open;
+    bool first = true;
+    for (IterT it = begin; it != end; ++it) {
+        if (!first) {
+            out += format.separator;
+        } else {
+            first = false;
+        }
+        append_range_element(out, *it, format, typename has_first_second<value_type>::type());
+    }
+    out += format.close;
+}
+
+// Serializes [begin, end) into out in a single pass using the given delimiters.
+// Contiguous numeric ranges skip the per-element dispatch.
+template<typename IterT>
+inline void append_range(std::string& out, IterT begin, IterT end, const range_format& format) {
+    append_range_impl(out, begin, end, format, typename is_contiguous_numeric_iterator<IterT>::type{});
+}
+
+// Element type of a range exposing data()/size()
+template<typename T>
+struct data_element_type {
+    typedef typename std::remove_cv<
+        typename std::remove_pointer<decltype(std::declval<const T&>().data())>::type
+    >::type type;
+};
+
+template<typename T, bool HasDataSize = has_data_size<T>::value>
+struct is_contiguous_numeric_range : std::false_type {};
+
+template<typename T>
+struct is_contiguous_numeric_range<T, true> : std::integral_constant<bool,
+    is_numeric<typename data_element_type<T>::type>::value &&
+    uses_builtin_conversion<typename data_element_type<T>::type>::value
+> {};
+
+typedef std::integral_constant<int, 0> numeric_data_range_tag;
+typedef std::integral_constant<int, 1> begin_end_range_tag;
+typedef std::integral_constant<int, 2> data_size_range_tag;
+
+template<typename T>
+inline void append_plain_range_impl(std::string& out, const T& range, numeric_data_range_tag) {
+    append_numeric_array(out, range.data(), static_cast<std::size_t>(range.size()), default_sequence_format());
+}
+
+template<typename T>
+inline void append_plain_range_impl(std::string& out, const T& range, begin_end_range_tag) {
+    using value_type = typename std::iterator_traits<decltype(range.begin())>::value_type;
+    append_range(out, range.begin(), range.end(), default_range_format<value_type>());
+}
+
+template<typename T>
+inline void append_plain_range_impl(std::string& out, const T& range, data_size_range_tag) {
+    using value_type = typename data_element_type<T>::type;
+    append_range(out, range.data(), range.data() + range.size(), default_range_format<value_type>());
+}
+
+template<typename T>
+inline void append_plain_range(std::string& out, const T& range) {
+    append_plain_range_impl(out, range, std::integral_constant<int,
+        is_contiguous_numeric_range<T>::value ? 0 : (has_begin_end<T>::value ? 1 : 2)>{});
+}
+
+} // namespace details
+
+/**
+ * @brief Convert a range defined by iterators to a string representation
+ * 
+ * This function converts a range of elements defined by iterators into
+ * a comma-separated list surrounded by square brackets, e.g., [1, 2, 3].
+ * For iterators pointing to key-value pairs (like those from std::map),
+ * it uses a JSON-like format, e.g., {"key1": "value1", "key2": "value2"}.
+ * 
+ * @tparam IterT Type of the iterator
+ * @param begin Begin iterator of the container
+ * @param end End iterator of the container
+ * @return String representation of the container contents
+ * 
+ * @code{.cpp}
+ * // Vector example
+ * std::vector<int> vec = {1, 2, 3};
+ * auto s1 = ustr::to_string(vec.cbegin(), vec.cend());  // "[1, 2, 3]"
+ * 
+ * // Map example
+ * std::map<std::string, int> map = {{"a", 1}, {"b", 2}};
+ * auto s2 = ustr::to_string(map.cbegin(), map.cend());  // "{"a": 1, "b": 2}"
+ * @endcode
+ */ 
+template<typename IterT>
+inline std::string to_string(IterT begin, IterT end) {
+    using value_type = typename std::iterator_traits<IterT>::value_type;
+    std::string out;
+    details::append_range(out, begin, end, details::default_range_format<value_type>());
+    return out;
+}
+
+/**
+ * @brief Join elements of a range using the given delimiters
+ *
+ * Elements are converted with the same rules as ustr::to_string. Pair-like
+ * elements (std::map entries) are written as first, key_value_separator, second.
+ * Works with any type supporting std::begin/std::end, including C arrays.
+ *
+ * @tparam RangeT Type of the range
+ * @param range Range to join
+ * @param format Delimiters and quoting options
+ * @return Joined string
+ *
+ * @code{.cpp}
+ * std::map<std::string, std::string> labels = {{"job", "api"}, {"env", "prod"}};
+ * ustr::join(labels, ustr::range_format(",", "{", "}", "=")); // {"env"="prod","job"="api"}
+ * @endcode
+ */
+template<typename RangeT>
+inline std::string join(const RangeT& range, const range_format& format) {
+    std::string out;
+    details::append_range(out, std::begin(range), std::end(range), format);
+    return out;
+}
+
+/**
+ * @brief Join elements of a range with a separator and optional open/close delimiters
+ *
+ * Unlike container formatting, string elements are not quoted, which makes
+ * this suitable for CSV lines or space-separated lists. Use the range_format
+ * overload to enable quoting or change the key/value separator.
+ *
+ * @code{.cpp}
+ * std::vector<int> v = {1, 2, 3};
+ * ustr::join(v, ",");              // "1,2,3"
+ * ustr::join(v, " ", "<", ">");    // "<1 2 3>"
+ * @endcode
+ */
+template<typename RangeT>
+inline std::string join(const RangeT& range, const std::string& separator,
+                        const std::string& open = std::string(),
+                        const std::string& close = std::string()) {
+    return join(range, range_format(separator, open, close, ": ", false));
+}
+
+namespace details {
+
+// Characters that force quoting of a logfmt value
+inline bool logfmt_needs_quoting(char c) {
+    return static_cast<unsigned char>(c) <= ' ' || c == '=' || c == '"' || c == '\x7f';
+}
+
+// Writes s as a quoted logfmt value, escaping quotes, backslashes and control characters.
+// Control characters without a short escape (NUL, ESC, ...) and DEL become \xNN.
+inline void append_logfmt_escaped(std::string& out, const char* s, std::size_t length) {
+    static const char digits[] = "0123456789abcdef";
+    char hex[5] = {'\\', 'x', '0', '0', '\0'};
+    out += '"';
+    std::size_t run_start = 0;
+    for (std::size_t i = 0; i < length; ++i) {
+        const unsigned char c = static_cast<unsigned char>(s[i]);
+        const char* replacement = hex;
+        switch (c) {
+            case '"':  replacement = "\\\""; break;
+            case '\\': replacement = "\\\\"; break;
+            case '\n': replacement = "\\n"; break;
+            case '\r': replacement = "\\r"; break;
+            case '\t': replacement = "\\t"; break;
+            default:
+                if (c >= ' ' && c != 0x7f) {
+                    continue;
+                }
+                hex[2] = digits[c >> 4];
+                hex[3] = digits[c & 0xF];
+        }
+        out.append(s + run_start, i - run_start);
+        out += replacement;
+        run_start = i + 1;
+    }
+    out.append(s + run_start, length - run_start);
+    out += '"';
+}
+
+// Copies a logfmt value; the scan that finds the end of the plain prefix
+// also decides whether the value has to be quoted. Empty values are quoted.
+inline void append_logfmt_string(std::string& out, const char* s, std::size_t length) {
+    std::size_t i = 0;
+    while (i < length && !logfmt_needs_quoting(s[i])) {
+        ++i;
+    }
+    if (i == length && length != 0) {
+        out.append(s, length);
+    } else {
+        append_logfmt_escaped(out, s, length);
+    }
+}
+
+inline void append_logfmt_special(std::string& out, const std::string& value) {
+    append_logfmt_string(out, value.data(), value.size());
+}
+
+inline void append_logfmt_special(std::string& out, const char* value) {
+    const char* s = value ? value : get_null_string();
+    append_logfmt_string(out, s, std::strlen(s));
+}
+
+#if __cplusplus >= 201703L
+inline void append_logfmt_special(std::string& out, std::string_view value) {
+    append_logfmt_string(out, value.data(), value.size());
+}
+#endif
+
+// Numbers never need quoting
+template<typename T>
+inline auto append_logfmt_value(std::string& out, const T& value)
+    -> typename std::enable_if<
+        uses_builtin_conversion<T>::value &&
+        is_numeric<T>::value
+    >::type {
+    append_value(out, value);
+}
+
+// Strings are checked while being copied
+template<typename T>
+inline auto append_logfmt_value(std::string& out, const T& value)
+    -> typename std::enable_if<
+        uses_builtin_conversion<T>::value &&
+        is_quotable_string<T>::value
+    >::type {
+    append_logfmt_special(out, value);
+}
+
+// Other values are converted in place and quoted afterwards if required
+template<typename T>
+inline auto append_logfmt_value(std::string& out, const T& value)
+    -> typename std::enable_if<
+        !(uses_builtin_conversion<T>::value &&
+          (is_numeric<T>::value || is_quotable_string<T>::value))
+    >::type {
+    const std::size_t start = out.size();
+    append_value(out, value);
+    for (std::size_t i = start; i < out.size(); ++i) {
+        if (logfmt_needs_quoting(out[i])) {
+            const std::string field = out.substr(start);
+            out.resize(start);
+            append_logfmt_escaped(out, field.data(), field.size());
+            return;
+        }
+    }
+    if (out.size() == start) {
+        out += "\"\"";
+    }
+}
+
+// Keys cannot be quoted in logfmt: characters that would break parsing become '_'
+template<typename T>
+inline void append_logfmt_key(std::string& out, const T& key) {
+    const std::size_t start = out.size();
+    append_value(out, key);
+    for (std::size_t i = start; i < out.size(); ++i) {
+        if (logfmt_needs_quoting(out[i])) {
+            out[i] = '_';
+        }
+    }
+    if (out.size() == start) {
+        out += '_';
+    }
+}
+
+// Single pair-like field: key=value
+template<typename T>
+inline auto append_logfmt_fields(std::string& out, const T& field, bool& first)
+    -> typename std::enable_if<has_first_second<T>::value>::type {
+    if (!first) {
+        out += ' ';
+    }
+    first = false;
+    append_logfmt_key(out, field.first);
+    out += '=';
+    append_logfmt_value(out, field.second);
+}
+
+// Container of pair-like elements (std::map, std::vector<std::pair<...>>)
+template<typename T>
+inline auto append_logfmt_fields(std::string& out, const T& fields, bool& first)
+    -> typename std::enable_if<
+        has_cbegin_cend<T>::value &&
+        has_first_second<typename T::value_type>::value
+    >::type {
+    for (auto it = fields.cbegin(); it != fields.cend(); ++it) {
+        append_logfmt_fields(out, *it, first);
+    }
+}
+
+// Writes reflected struct fields as name=value
+struct logfmt_field_writer {
+    std::string& out;
+    bool& first;
+
+    template<typename M>
+    void operator()(const char* name, const M& field_value) {
+        if (!first) {
+            out += ' ';
+        }
+        first = false;
+        out += name;
+        out += '=';
+        append_logfmt_value(out, field_value);
+    }
+};
+
+// Struct registered with USTR_REFLECT
+template<typename T>
+inline auto append_logfmt_fields(std::string& out, const T& fields, bool& first)
+    -> typename std::enable_if<
+        is_reflectable<T>::value &&
+        !has_first_second<T>::value &&
+        !is_tuple<T>::value
+    >::type {
+    logfmt_field_writer writer = {out, first};
+    visit_reflected_fields(fields, writer);
+}
+
+// Tuple of fields: each element is a pair-like field, a container of fields or a reflected struct
+template<typename T, std::size_t... Indices>
+inline void append_logfmt_tuple(std::string& out, const T& fields, bool& first, index_sequence<Indices...>);
+
+template<typename T>
+inline auto append_logfmt_fields(std::string& out, const T& fields, bool& first)
+    -> typename std::enable_if<is_tuple<T>::value>::type {
+    append_logfmt_tuple(out, fields, first, make_index_sequence<std::tuple_size<T>::value>{});
+}
+
+template<typename T, std::size_t... Indices>
+inline void append_logfmt_tuple(std::string& out, const T& fields, bool& first, index_sequence<Indices...>) {
+    (void)std::initializer_list<int>{(append_logfmt_fields(out, std::get<Indices>(fields), first), 0)...};
+    (void)out;
+    (void)first;
+}
+
+} // namespace details
+
+/**
+ * @brief Append fields in logfmt format (key=value pairs separated by spaces)
+ *
+ * Accepts a single pair, a container of pair-like elements (e.g. std::map), a
+ * struct registered with USTR_REFLECT or a tuple whose elements are any of these.
+ * Values are quoted only when they are empty or contain spaces, '=', '"' or
+ * control characters; quotes, backslashes and line breaks inside quoted values
+ * are escaped. Key characters that are not allowed in logfmt are replaced with '_'.
+ *
+ * @param out String to append to
+ * @param fields Fields to write
+ * @return Reference to out
+ *
+ * @code{.cpp}
+ * std::string line = "level=info ";
+ * ustr::append_logfmt(line, std::make_tuple(std::make_pair("user", 42),
+ *                                           std::make_pair("msg", "logged in")));
+ * // level=info user=42 msg="logged in"
+ * @endcode
+ */
+template<typename T>
+inline std::string& append_logfmt(std::string& out, const T& fields) {
+    bool first = out.empty() || out.back() == ' ';
+    details::append_logfmt_fields(out, fields, first);
+    return out;
+}
+
+/**
+ * @brief Convert fields to a logfmt line
+ *
+ * @code{.cpp}
+ * std::map<std::string, std::string> labels = {{"env", "prod"}, {"msg", "a b"}};
+ * ustr::to_logfmt(labels);  // env=prod msg="a b"
+ * @endcode
+ */
+template<typename T>
+inline std::string to_logfmt(const T& fields) {
+    std::string out;
+    append_logfmt(out, fields);
+    return out;
+}
+
+/**
+ * @brief Get a readable name of a type
+ *
+ * The name is sliced from the compiler's function signature (__PRETTY_FUNCTION__
+ * or __FUNCSIG__), so no demangling is needed at run time. It is computed once per
+ * type and cached. The exact spelling depends on the compiler, e.g. GCC gives
+ * "std::__cxx11::basic_string<char>" for std::string.
+ *
+ * @tparam T Type to name
+ * @return Reference to the cached name
+ *
+ * @code{.cpp}
+ * ustr::type_name<int>();            // "int"
+ * ustr::type_name<my::Widget>();     // "my::Widget"
+ * @endcode
+ */
+template<typename T>
+inline const std::string& type_name() {
+    return details::type_name_impl<T>();
+}
+
+#if __cplusplus >= 201703L && defined(USTR_FUNCTION_SIGNATURE_)
+/**
+ * @brief Get the name of a type at compile time (C++17)
+ *
+ * @code{.cpp}
+ * static_assert(ustr::type_name_view<int>() == "int");
+ * @endcode
+ */
+template<typename T>
+constexpr std::string_view type_name_view() {
+    constexpr std::string_view signature = details::type_signature<T>();
+    constexpr details::type_signature_layout layout = details::get_type_signature_layout();
+    return signature.substr(layout.prefix, signature.size() - layout.prefix - layout.suffix);
+}
+#endif
+
+/** @} */ // end of api group
+
+/**
+ * @defgroup formatters Local Scope Formatters
+ * @brief Classes for customizing formatting within specific scopes
+ * @{
+ */
+
+/**
+ * @brief Base class for custom formatters
+ * 
+ * Allows customization of how specific types are converted to strings
+ * within a local scope, enabling different formatting rules for the
+ * same types in different contexts.
+ */
+template<typename T>
+class formatter_base {
+public:
+    virtual ~formatter_base() = default;
+    virtual std::string format(const T& value) const = 0;
+
+    /**
+     * @brief Append the formatted value to out
+     * 
+     * format_context calls this while serializing, so formatters that override it
+     * write straight into the output. The default appends the result of format().
+     */
+    virtual void format_to(const T& value, std::string& out) const {
+        out += format(value);
+    }
+};
+
+/**
+ * @brief Base class for formatters that write into an output buffer
+ * 
+ * Derived classes implement format_to(); format() is provided on top of it.
+ */
+template<typename T>
+class buffer_formatter_base : public formatter_base<T> {
+public:
+    void format_to(const T& value, std::string& out) const override = 0;
+
+    std::string format(const T& value) const final {
+        std::string out;
+        format_to(value, out);
+        return out;
+    }
+};
+
+namespace details {
+
+// Detects functions called as func(value, out) to append to an output buffer
+template<typename Func, typename T, typename = void>
+struct is_buffer_format_func : std::false_type {};
+
+template<typename Func, typename T>
+struct is_buffer_format_func<Func, T, typename std::enable_if<std::is_void<
+    decltype(std::declval<const Func&>()(std::declval<const T&>(), std::declval<std::string&>()))
+>::value>::type> : std::true_type {};
+
+} // namespace details
+
+/**
+ * @brief Lambda-based formatter for easy inline customization
+ * 
+ * Func either returns the formatted string, e.g. [](bool b) { return b ? "YES" : "NO"; },
+ * or appends to an output buffer, e.g. [](int i, std::string& out) { out += '#'; ustr::append_to(out, i); }.
+ * 
+ * @tparam T Type to format
+ * @tparam Func Function type (usually auto-deduced)
+ */
+template<typename T, typename Func>
+class lambda_formatter : public formatter_base<T> {
+private:
+    Func func_;
+
+    std::string format_impl(const T& value, std::false_type) const {
+        return func_(value);
+    }
+
+    std::string format_impl(const T& value, std::true_type) const {
+        std::string out;
+        func_(value, out);
+        return out;
+    }
+
+    void format_to_impl(const T& value, std::string& out, std::false_type) const {
+        out += func_(value);
+    }
+
+    void format_to_impl(const T& value, std::string& out, std::true_type) const {
+        func_(value, out);
+    }
+
+public:
+    explicit lambda_formatter(Func func) : func_(std::move(func)) {}
+    std::string format(const T& value) const override {
+        return format_impl(value, typename details::is_buffer_format_func<Func, T>::type{});
+    }
+    void format_to(const T& value, std::string& out) const override {
+        format_to_impl(value, out, typename details::is_buffer_format_func<Func, T>::type{});
+    }
+};
+
+namespace details {
+
+// Detects types formatted as ranges by the cbegin/cend container branch of to_string_impl
+template<typename T>
+struct is_range_container : std::integral_constant<bool,
+    uses_builtin_conversion<T>::value &&
+    !is_numeric<T>::value && 
+    !is_special_type<T>::value &&
+    !is_enum<T>::value &&
+    !is_pair<T>::value &&
+    !is_tuple<T>::value &&
+    !is_c_array<T>::value &&
+    !is_reflectable<T>::value &&
+    has_cbegin_cend<T>::value
+> {};
+
+inline std::size_t next_formatter_slot() {
+    static std::atomic<std::size_t> next(0);
+    return next.fetch_add(1);
+}
+
+// Index of T in the flattened formatter tables of format_context, assigned on first use
+template<typename T>
+inline std::size_t formatter_slot() {
+    static const std::size_t slot = next_formatter_slot();
+    return slot;
+}
+
+// Operations on the object held by a formatter_storage
+struct formatter_storage_ops {
+    void (*copy)(const void* from, void* to);
+    void (*move)(void* from, void* to);
+    void (*destroy)(void* object);
+    const void* (*get)(const void* object);
+    bool is_shared;
+};
+
+template<typename T>
+inline const formatter_base<T>* formatter_pointer(const formatter_base<T>& formatter) {
+    return &formatter;
+}
+
+template<typename T>
+inline const formatter_base<T>* formatter_pointer(const std::shared_ptr<formatter_base<T>>& formatter) {
+    return formatter.get();
+}
+
+// Stored is a formatter_base<T> implementation or a shared_ptr to one
+template<typename T, typename Stored>
+struct formatter_storage_ops_for {
+    static void copy(const void* from, void* to) {
+        ::new (to) Stored(*static_cast<const Stored*>(from));
+    }
+
+    static void move(void* from, void* to) {
+        ::new (to) Stored(std::move(*static_cast<Stored*>(from)));
+        static_cast<Stored*>(from)->~Stored();
+    }
+
+    static void destroy(void* object) {
+        static_cast<Stored*>(object)->~Stored();
+    }
+
+    // Pointer to the formatter_base<T> subobject, as looked up by format_context
+    static const void* get(const void* object) {
+        return formatter_pointer<T>(*static_cast<const Stored*>(object));
+    }
+
+    static const formatter_storage_ops table;
+};
+
+template<typename T, typename Stored>
+const formatter_storage_ops formatter_storage_ops_for<T, Stored>::table = {
+    &formatter_storage_ops_for::copy,
+    &formatter_storage_ops_for::move,
+    &formatter_storage_ops_for::destroy,
+    &formatter_storage_ops_for::get,
+    !std::is_base_of<formatter_base<T>, Stored>::value
+};
+
+// Type-erased formatter owned by a format_context. Formatters up to inline_size
+// bytes (a lambda_formatter capturing a few pointers) are stored in place, without
+// a heap allocation or reference count; larger, throwing-move and move-only ones
+// are kept on the heap behind a shared_ptr.
+class formatter_storage {
+public:
+    static const std::size_t inline_size = 5 * sizeof(void*);
+
+    formatter_storage() : ops_(nullptr) {}
+
+    formatter_storage(const formatter_storage& other) : ops_(other.ops_) {
+        if (ops_) {
+            ops_->copy(other.buffer_.bytes, buffer_.bytes);
+        }
+    }
+
+    formatter_storage(formatter_storage&& other) noexcept : ops_(other.ops_) {
+        if (ops_) {
+            ops_->move(other.buffer_.bytes, buffer_.bytes);
+            other.ops_ = nullptr;
+        }
+    }
+
+    formatter_storage& operator=(const formatter_storage& other) {
+        if (this != &other) {
+            formatter_storage copy(other);
+            *this = std::move(copy);
+        }
+        return *this;
+    }
+
+    formatter_storage& operator=(formatter_storage&& other) noexcept {
+        if (this != &other) {
+            reset();
+            if (other.ops_) {
+                other.ops_->move(other.buffer_.bytes, buffer_.bytes);
+                ops_ = other.ops_;
+                other.ops_ = nullptr;
+            }
+        }
+        return *this;
+    }
+
+    ~formatter_storage() {
+        reset();
+    }
+
+    // Stores a formatter_base<T> implementation, in place when it fits
+    template<typename T, typename F>
+    static formatter_storage create(F formatter) {
+        formatter_storage storage;
+        storage.emplace_formatter<T>(std::move(formatter), std::integral_constant<bool, fits_inline<F>::value>());
+        return storage;
+    }
+
+    // Shares a formatter owned elsewhere
+    template<typename T>
+    static formatter_storage create(std::shared_ptr<formatter_base<T>> formatter) {
+        formatter_storage storage;
+        storage.emplace<T>(std::move(formatter));
+        return storage;
+    }
+
+    // The stored formatter_base<T>, or nullptr
+    const void* get() const {
+        return ops_ ? ops_->get(buffer_.bytes) : nullptr;
+    }
+
+    // get() of this copy of other, computed from other.get() without calling
+    // into the stored type: formatters held in place move with the buffer
+    const void* rebase(const formatter_storage& other, const void* formatter) const {
+        const unsigned char* p = static_cast<const unsigned char*>(formatter);
+        std::less<const unsigned char*> before;
+        if (!before(p, other.buffer_.bytes) && before(p, other.buffer_.bytes + inline_size)) {
+            return buffer_.bytes + (p - other.buffer_.bytes);
+        }
+        return formatter;
+    }
+
+    bool is_inline() const {
+        return ops_ && !ops_->is_shared;
+    }
+
+    void reset() {
+        if (ops_) {
+            ops_->destroy(buffer_.bytes);
+            ops_ = nullptr;
+        }
+    }
+
+private:
+    template<typename F>
+    struct fits_inline : std::integral_constant<bool,
+        sizeof(F) <= inline_size &&
+        std::alignment_of<F>::value <= std::alignment_of<void*>::value &&
+        std::is_nothrow_move_constructible<F>::value &&
+        std::is_copy_constructible<F>::value
+    > {};
+
+    template<typename T, typename Stored>
+    void emplace(Stored object) {
+        ::new (static_cast<void*>(buffer_.bytes)) Stored(std::move(object));
+        ops_ = &formatter_storage_ops_for<T, Stored>::table;
+    }
+
+    template<typename T, typename F>
+    void emplace_formatter(F formatter, std::true_type) {
+        emplace<T>(std::move(formatter));
+    }
+
+    template<typename T, typename F>
+    void emplace_formatter(F formatter, std::false_type) {
+        emplace<T>(std::shared_ptr<formatter_base<T>>(std::make_shared<F>(std::move(formatter))));
+    }
+
+    const formatter_storage_ops* ops_;
+    union {
+        void* align_;
+        unsigned char bytes[inline_size];
+    } buffer_;
+};
+
+// Formatter set on a format_context, with the slot of its type
+struct formatter_entry {
+    std::size_t slot;
+    formatter_storage formatter;
+};
+
+// Kind of value for context-aware formatting: plain values, containers, pairs and tuples
+template<typename T>
+struct context_value_kind : std::integral_constant<int,
+    is_range_container<T>::value ? 1 :
+    !uses_builtin_conversion<T>::value ? 0 :
+    is_pair<T>::value ? 2 :
+    is_tuple<T>::value ? 3 : 0
+> {};
+
+// Formatters a format_context uses for a value of type T and everything nested in it.
+// All lookups happen when the plan is built, so a range costs one lookup per element
+// type instead of one per element.
+template<typename Context, typename T, int Kind = context_value_kind<T>::value>
+struct context_plan;
+
+template<typename Context, typename ValueT, bool PairLike = has_first_second<ValueT>::value>
+struct context_range_plan;
+
+// Plain value: custom formatter or the default append
+template<typename Context, typename T>
+struct context_plan<Context, T, 0> {
+    const formatter_base<T>* formatter;
+
+    explicit context_plan(const Context& ctx) : formatter(ctx.template find_formatter<T>()) {}
+
+    // True when elements of this type can go through the default range kernels
+    bool is_default() const {
+        return formatter == nullptr;
+    }
+
+    void append(std::string& out, const T& value, bool quote_strings) const {
+        if (formatter) {
+            formatter->format_to(value, out);
+        } else {
+            append_range_item(out, value, quote_strings);
+        }
+    }
+};
+
+// Container: custom formatter or the context range format applied to its elements
+template<typename Context, typename T>
+struct context_plan<Context, T, 1> {
+    typedef typename std::iterator_traits<decltype(std::declval<const T&>().cbegin())>::value_type value_type;
+
+    const formatter_base<T>* formatter;
+    const range_format& format;
+    context_range_plan<Context, value_type> elements;
+
+    explicit context_plan(const Context& ctx)
+        : formatter(ctx.template find_formatter<T>()),
+          format(ctx.template find_range_format<value_type>()),
+          elements(ctx) {}
+
+    bool is_default() const {
+        return false;
+    }
+
+    void append(std::string& out, const T& value, bool) const {
+        if (formatter) {
+            formatter->format_to(value, out);
+        } else {
+            elements.append(out, value.cbegin(), value.cend(), format);
+        }
+    }
+};
+
+// std::pair: "(first, second)" like the default pair formatting. Members are looked up
+// by their decayed type, so a formatter for int also applies to const int and int&.
+template<typename Context, typename T>
+struct context_plan<Context, T, 2> {
+    const formatter_base<T>* formatter;
+    context_plan<Context, typename std::decay<typename T::first_type>::type> first;
+    context_plan<Context, typename std::decay<typename T::second_type>::type> second;
+
+    explicit context_plan(const Context& ctx)
+        : formatter(ctx.template find_formatter<T>()), first(ctx), second(ctx) {}
+
+    bool is_default() const {
+        return false;
+    }
+
+    void append(std::string& out, const T& value, bool) const {
+        if (formatter) {
+            formatter->format_to(value, out);
+            return;
+        }
+        out += '(';
+        first.append(out, value.first, true);
+        out += ", ";
+        second.append(out, value.second, true);
+        out += ')';
+    }
+};
+
+// std::tuple: "(a, b, c)" like tuple_to_string_impl, fields looked up by decayed type
+template<typename Context, typename... Args>
+struct context_plan<Context, std::tuple<Args...>, 3> {
+    typedef std::tuple<Args...> tuple_type;
+
+    const formatter_base<tuple_type>* formatter;
+    std::tuple<context_plan<Context, typename std::decay<Args>::type>...> fields;
+
+    explicit context_plan(const Context& ctx)
+        : formatter(ctx.template find_formatter<tuple_type>()),
+          fields(context_plan<Context, typename std::decay<Args>::type>(ctx)...) {}
+
+    bool is_default() const {
+        return false;
+    }
+
+    template<std::size_t... Indices>
+    void append_fields(std::string& out, const tuple_type& value, index_sequence<Indices...>) const {
+        bool first = true;
+        (void)std::initializer_list<int>{(
+            first ? (void)(first = false) : (void)(out += ", "),
+            std::get<Indices>(fields).append(out, std::get<Indices>(value), true), 0)...};
+        (void)first; // Suppress unused variable warnings for empty tuples
+        (void)out;
+        (void)value;
+    }
+
+    void append(std::string& out, const tuple_type& value, bool) const {
+        if (formatter) {
+            formatter->format_to(value, out);
+            return;
+        }
+        out += '(';
+        append_fields(out, value, make_index_sequence<sizeof...(Args)>{});
+        out += ')';
+    }
+};
+
+// Elements of a sequence container
+template<typename Context, typename ValueT>
+struct context_range_plan<Context, ValueT, false> {
+    context_plan<Context, ValueT> element;
+
+    explicit context_range_plan(const Context& ctx) : element(ctx) {}
+
+    template<typename IterT>
+    void append(std::string& out, IterT begin, IterT end, const range_format& format) const {
+        if (element.is_default()) {
+            // No formatter applies: keep the default kernels, including the numeric fast path
+            append_range(out, begin, end, format);
+            return;
+        }
+        out += format.open;
+        bool first = true;
+        for (IterT it = begin; it != end; ++it) {
+            if (!first) {
+                out += format.separator;
+            } else {
+                first = false;
+            }
+            element.append(out, *it, format.quote_strings);
+        }
+        out += format.close;
+    }
+};
+
+// Pair-like elements of a map: key, separator, value
+template<typename Context, typename ValueT>
+struct context_range_plan<Context, ValueT, true> {
+    typedef typename std::decay<decltype(std::declval<const ValueT&>().first)>::type key_type;
+    typedef typename std::decay<decltype(std::declval<const ValueT&>().second)>::type mapped_type;
+
+    const formatter_base<ValueT>* formatter;
+    context_plan<Context, key_type> key;
+    context_plan<Context, mapped_type> mapped;
+
+    explicit context_range_plan(const Context& ctx)
+        : formatter(ctx.template find_formatter<ValueT>()), key(ctx), mapped(ctx) {}
+
+    template<typename IterT>
+    void append(std::string& out, IterT begin, IterT end, const range_format& format) const {
+        if (!formatter && key.is_default() && mapped.is_default()) {
+            append_range(out, begin, end, format);
+            return;
+        }
+        out += format.open;
+        bool first = true;
+        for (IterT it = begin; it != end; ++it) {
+            if (!first) {
+                out += format.separator;
+            } else {
+                first = false;
+            }
+            if (formatter) {
+                formatter->format_to(*it, out);
+                continue;
+            }
+            key.append(out, it->first, format.quote_strings);
+            out += format.key_value_separator;
+            mapped.append(out, it->second, format.quote_strings);
+        }
+        out += format.close;
+    }
+};
+
+} // namespace details
+
+namespace details {
+
+// Formatters and range formats of a format_context. Copies of a context share one
+// table, which is copied before any of them changes it, so a shared table is never
+// modified.
+struct format_table {
+    // Table this one was derived from; holds the inherited formatters
+    std::shared_ptr<format_table> parent;
+    // Own formatters (overrides when there is a parent), stored contiguously with
+    // small formatters held in place
+    std::vector<formatter_entry> formatters;
+    // Own and inherited formatters indexed by formatter_slot, so lookups cost the
+    // same at any depth of the parent chain
+    std::vector<const void*> slots;
+    std::size_t active_slots = 0;
+    std::shared_ptr<const range_format> sequence_format;
+    std::shared_ptr<const range_format> map_format;
+
+    format_table() = default;
+
+    // Copied when a shared table is about to change, so room is left for one more formatter
+    format_table(const format_table& other)
+        : parent(other.parent),
+          slots(other.slots),
+          active_slots(other.active_slots),
+          sequence_format(other.sequence_format),
+          map_format(other.map_format) {
+        formatters.reserve(other.formatters.size() + 1);
+        formatters.insert(formatters.end(), other.formatters.begin(), other.formatters.end());
+        for (std::size_t i = 0; i < formatters.size(); ++i) {
+            const std::size_t slot = formatters[i].slot;
+            if (const void* formatter = other.find(slot)) {
+                slots[slot] = formatters[i].formatter.rebase(other.formatters[i].formatter, formatter);
+            }
+        }
+    }
+
+    format_table& operator=(const format_table&) = delete;
+
+    // Table with no own formatters on top of base
+    explicit format_table(std::shared_ptr<format_table> base)
+        : slots(base->slots),
+          active_slots(base->active_slots),
+          sequence_format(base->sequence_format),
+          map_format(base->map_format) {
+        parent = std::move(base);
+    }
+
+    // Shared by all contexts without formatters, so creating one does not allocate
+    static const std::shared_ptr<format_table>& empty() {
+        static const std::shared_ptr<format_table> table = std::make_shared<format_table>();
+        return table;
+    }
+
+    const void* find(std::size_t slot) const {
+        return slot < slots.size() ? slots[slot] : nullptr;
+    }
+
+    void set_slot(std::size_t slot, const void* formatter) {
+        if (slot >= slots.size()) {
+            if (!formatter) {
+                return;
+            }
+            slots.resize(slot + 1, nullptr);
+        }
+        if (!slots[slot] && formatter) {
+            ++active_slots;
+        } else if (slots[slot] && !formatter) {
+            --active_slots;
+        }
+        slots[slot] = formatter;
+    }
+
+    // Points the slots of own formatters at their current storage; needed whenever
+    // formatters is copied or reallocated, since small formatters live inside it
+    void bind_own_slots() {
+        for (const formatter_entry& entry : formatters) {
+            set_slot(entry.slot, entry.formatter.get());
+        }
+    }
+
+    std::vector<formatter_entry>::iterator find_entry(std::size_t slot) {
+        auto it = formatters.begin();
+        while (it != formatters.end() && it->slot != slot) {
+            ++it;
+        }
+        return it;
+    }
+
+    bool has_own(std::size_t slot) const {
+        for (const formatter_entry& entry : formatters) {
+            if (entry.slot == slot) {
+                return true;
+            }
+        }
+        return false;
+    }
+
+    void set(std::size_t slot, formatter_storage formatter) {
+        auto it = find_entry(slot);
+        if (it != formatters.end()) {
+            it->formatter = std::move(formatter);
+            set_slot(slot, it->formatter.get());
+            return;
+        }
+        const formatter_entry* data = formatters.data();
+        formatters.push_back(formatter_entry{slot, std::move(formatter)});
+        if (formatters.data() == data) {
+            set_slot(slot, formatters.back().formatter.get());
+        } else {
+            bind_own_slots();
+        }
+    }
+
+    void remove(std::size_t slot) {
+        auto it = find_entry(slot);
+        if (it != formatters.end()) {
+            // The last entry takes the place of the removed one
+            if (&*it != &formatters.back()) {
+                *it = std::move(formatters.back());
+                set_slot(it->slot, it->formatter.get());
+            }
+            formatters.pop_back();
+            set_slot(slot, parent ? parent->find(slot) : nullptr);
+        }
+    }
+};
+
+} // namespace details
+
+/**
+ * @brief Format context for local customization
+ * 
  * This class allows you to specify custom formatting rules for specific
  * types within a limited scope. When the context goes out of scope,
  * the default formatting is restored.
@@ -886,12 +3166,104 @@ public:
  * std::string result1 = ctx.to_string(true);    // "YES"
  * std::string result2 = ctx.to_string(3.14159f); // "3.14"
  * @endcode
+ *
+ * Threading: a format_context follows the rules of standard containers. Const
+ * members may be called on one context from several threads; changing it needs
+ * exclusive access. Copies and children share tables copy-on-write, so separate
+ * copies may be used and changed on different threads without locking. Shared
+ * formatters are then called concurrently and must allow that.
  */
 class format_context {
 private:
-    std::map<std::type_index, std::shared_ptr<void>> formatters_;
+    std::shared_ptr<const format_context> parent_;
+    std::shared_ptr<details::format_table> table_ = details::format_table::empty();
+    // True while table_ is the parent's table, before the first override
+    bool shares_parent_table_ = false;
+
+    template<typename Context, typename T, int Kind>
+    friend struct details::context_plan;
+    template<typename Context, typename ValueT, bool PairLike>
+    friend struct details::context_range_plan;
+
+    // Formatter registered for T here or in a parent, or nullptr
+    template<typename T>
+    const formatter_base<T>* find_formatter() const {
+        return static_cast<const formatter_base<T>*>(table_->find(details::formatter_slot<T>()));
+    }
+
+    // Table that only this context refers to, copied or derived from the parent's first
+    details::format_table& mutable_table() {
+        if (shares_parent_table_) {
+            table_ = std::make_shared<details::format_table>(table_);
+            shares_parent_table_ = false;
+        } else if (table_.use_count() > 1) {
+            table_ = std::make_shared<details::format_table>(*table_);
+        } else {
+            // A copy released on another thread may have read the table just before;
+            // pairs with the release in its reference count decrement
+            std::atomic_thread_fence(std::memory_order_acquire);
+        }
+        return *table_;
+    }
+
+    // Delimiters for a range of ValueT: the context range formats when set
+    template<typename ValueT>
+    const range_format& find_range_format() const {
+        const range_format* format = details::has_first_second<ValueT>::value
+            ? table_->map_format.get() : table_->sequence_format.get();
+        return format ? *format : details::default_range_format<ValueT>();
+    }
+
+    // Nothing to customize: the free ustr::to_string produces the same output
+    bool is_default() const {
+        return table_->active_slots == 0 && !table_->sequence_format && !table_->map_format;
+    }
 
 public:
+    format_context() = default;
+
+    /**
+     * @brief Copy a context in constant time
+     * 
+     * The copy shares the formatter table with other until one of them changes
+     * its formatters or range formats. Contexts sharing a table can be used from
+     * different threads; a single context is not synchronized.
+     */
+    format_context(const format_context& other) = default;
+    format_context& operator=(const format_context& other) = default;
+
+    /**
+     * @brief Create a child context that falls back to a parent
+     *
+     * The child starts with the parent's formatters and range formats and holds
+     * only its own overrides, so creating one does not copy the parent's formatters.
+     * Lookups go through a flattened table and cost the same at any chain depth.
+     * Later changes to the parent are not seen by existing children.
+     *
+     * @param parent Context consulted for types without an override
+     *
+     * @code{.cpp}
+     * auto global = std::make_shared<ustr::format_context>();
+     * global->set_formatter<double>(...);
+     * ustr::format_context request(global);
+     * request.set_formatter<std::string>([](const std::string&) { return "***"; });
+     * @endcode
+     */
+    explicit format_context(std::shared_ptr<const format_context> parent)
+        : parent_(std::move(parent)) {
+        if (parent_) {
+            table_ = parent_->table_;
+            shares_parent_table_ = true;
+        }
+    }
+
+    /**
+     * @brief Parent context, or nullptr for a root context
+     */
+    const std::shared_ptr<const format_context>& parent() const {
+        return parent_;
+    }
+
     /**
      * @brief Set a custom formatter for type T
      * @tparam T Type to format
@@ -899,19 +3271,21 @@ public:
      */
     template<typename T>
     void set_formatter(std::shared_ptr<formatter_base<T>> formatter) {
-        formatters_[std::type_index(typeid(T))] = formatter;
+        mutable_table().set(details::formatter_slot<T>(), details::formatter_storage::create<T>(std::move(formatter)));
     }
 
     /**
      * @brief Set a custom formatter using a lambda function
      * @tparam T Type to format
      * @tparam Func Function type
-     * @param func Lambda or function for formatting
+     * @param func Lambda or function for formatting, returning the string or
+     *             appending to an output buffer (see lambda_formatter)
      */
-    template<typename T, typename Func>
+    template<typename T, typename Func, typename = typename std::enable_if<
+        !std::is_convertible<Func, std::shared_ptr<formatter_base<T>>>::value>::type>
     void set_formatter(Func func) {
-        auto formatter = std::make_shared<lambda_formatter<T, Func>>(std::move(func));
-        formatters_[std::type_index(typeid(T))] = formatter;
+        mutable_table().set(details::formatter_slot<T>(),
+                            details::formatter_storage::create<T>(lambda_formatter<T, Func>(std::move(func))));
     }
 
     /**
@@ -922,39 +3296,103 @@ public:
      */
     template<typename T>
     std::string to_string(const T& value) const {
-        auto it = formatters_.find(std::type_index(typeid(T)));
-        if (it != formatters_.end()) {
-            auto formatter = std::static_pointer_cast<formatter_base<T>>(it->second);
-            return formatter->format(value);
+        if (is_default()) {
+            return ustr::to_string(value);
+        }
+        // Elements of containers, pairs and tuples use the context formatters too
+        std::string out;
+        details::context_plan<format_context, T>(*this).append(out, value, false);
+        return out;
+    }
+
+    /**
+     * @brief Append value to out using custom formatters if available
+     * 
+     * Formatters implementing format_to() write straight into out.
+     * @tparam T Type of value
+     * @param out String to append to
+     * @param value Value to convert
+     * @return Reference to @p out
+     */
+    template<typename T>
+    std::string& append_to(std::string& out, const T& value) const {
+        if (is_default()) {
+            return ustr::append_to(out, value);
         }
-        // Fall back to default formatting
-        return ustr::to_string(value);
+        details::context_plan<format_context, T>(*this).append(out, value, false);
+        return out;
+    }
+
+    /**
+     * @brief Convert an iterator range to string using custom formatters if available
+     * @tparam IterT Iterator type
+     * @param begin Iterator to the first element
+     * @param end Iterator past the last element
+     * @return Formatted string, e.g. "[1, 2, 3]" with the context formatters applied to elements
+     */
+    template<typename IterT>
+    std::string to_string(IterT begin, IterT end) const {
+        using value_type = typename std::iterator_traits<IterT>::value_type;
+        std::string out;
+        details::context_range_plan<format_context, value_type>(*this).append(out, begin, end, find_range_format<value_type>());
+        return out;
+    }
+
+    /**
+     * @brief Set delimiters used for sequence containers (vector, list, set, ...)
+     * @param format Range format applied while serializing, e.g. range_format(",", "", "")
+     */
+    void set_range_format(const range_format& format) {
+        mutable_table().sequence_format = std::make_shared<const range_format>(format);
+    }
+
+    /**
+     * @brief Set delimiters used for containers of pair-like elements (map, unordered_map, ...)
+     * @param format Range format applied while serializing, e.g. range_format(",", "{", "}", "=")
+     */
+    void set_map_format(const range_format& format) {
+        mutable_table().map_format = std::make_shared<const range_format>(format);
     }
 
     /**
      * @brief Check if a custom formatter is set for type T
      * @tparam T Type to check
-     * @return true if custom formatter exists
+     * @return true if custom formatter exists, here or in a parent
      */
     template<typename T>
     bool has_formatter() const {
-        return formatters_.find(std::type_index(typeid(T))) != formatters_.end();
+        return find_formatter<T>() != nullptr;
     }
 
     /**
      * @brief Remove custom formatter for type T
+     * 
+     * In a child context the parent's formatter for T, if any, applies again.
      * @tparam T Type to remove formatter for
      */
     template<typename T>
     void remove_formatter() {
-        formatters_.erase(std::type_index(typeid(T)));
+        const std::size_t slot = details::formatter_slot<T>();
+        if (!shares_parent_table_ && table_->has_own(slot)) {
+            mutable_table().remove(slot);
+        }
     }
 
     /**
-     * @brief Clear all custom formatters
+     * @brief Clear all custom formatters and range formats
+     * 
+     * A child context drops its overrides and falls back to its parent.
      */
     void clear() {
-        formatters_.clear();
+        if (shares_parent_table_) {
+            return;
+        }
+        if (table_->parent) {
+            table_ = table_->parent;
+            shares_parent_table_ = true;
+        } else {
+            table_ = details::format_table::empty();
+        }
     }
 };
 
@@ -987,72 +3425,7 @@ public:
  */
 inline std::string quoted_str(const std::string& s, char start_delim, char end_delim, char escape, bool is_utf8) {
     std::string result;
-    
-    // Estimate capacity: original size + 2 delimiters + potential escapes
-    // We use a conservative estimate of 25% potential escapes
-    result.reserve(s.length() + 2 + (s.length() / 4));
-    
-    // Add opening delimiter
-    result += start_delim;
-    
-    // Skip BOM if present at the beginning
-    std::size_t start_pos = 0;
-    if (s.length() >= 3 && 
-        static_cast<unsigned char>(s[0]) == 0xEF && 
-        static_cast<unsigned char>(s[1]) == 0xBB && 
-        static_cast<unsigned char>(s[2]) == 0xBF) {
-        // UTF-8 BOM detected, skip it
-        start_pos = 3;
-    }
-    
-    if (escape != '\0') {
-        // Escape mode: scan for start_delim, end_delim, and escape characters
-        if (is_utf8) {
-            // UTF-8 aware mode: handle multi-byte characters
-            for (std::size_t i = start_pos; i < s.length(); ) {
-                unsigned char c = static_cast<unsigned char>(s[i]);
-                
-                // Check if this is a UTF-8 multi-byte character
-                if (c >= 0x80) {
-                    // UTF-8 multi-byte character
-                    std::size_t byte_count = 1;
-                    if ((c & 0xE0) == 0xC0) byte_count = 2;      // 110xxxxx
-                    else if ((c & 0xF0) == 0xE0) byte_count = 3; // 1110xxxx
-                    else if ((c & 0xF8) == 0xF0) byte_count = 4; // 11110xxx
-                    
-                    // Add the entire UTF-8 sequence
-                    for (std::size_t j = 0; j < byte_count && i + j < s.length(); ++j) {
-                        result += s[i + j];
-                    }
-                    i += byte_count;
-                } else {
-                    // ASCII character - check if it needs escaping
-                    char ch = static_cast<char>(c);
-                    if (ch == start_delim || ch == end_delim || ch == escape) {
-                        result += escape;
-                    }
-                    result += ch;
-                    ++i;
-                }
-            }
-        } else {
-            // ASCII-only mode: treat each byte independently (high performance)
-            for (std::size_t i = start_pos; i < s.length(); ++i) {
-                char ch = s[i];
-                if (ch == start_delim || ch == end_delim || ch == escape) {
-                    result += escape;
-                }
-                result += ch;
-            }
-        }
-    } else {
-        // No escaping: just add all characters (but skip BOM)
-        result += s.substr(start_pos);
-    }
-    
-    // Add closing delimiter
-    result += end_delim;
-    
+    details::append_quoted(result, s.data(), s.size(), start_delim, end_delim, escape, is_utf8);
     return result;
 }
 
@@ -1071,6 +3444,45 @@ inline std::string quoted_str(const char* s) {
     return quoted_str(std::string(s), details::DEFAULT_QUOTATION_DELIMITER, details::DEFAULT_QUOTATION_DELIMITER, details::DEFAULT_QUOTATION_ESCAPE_CHAR, details::DEFAULT_QUOTATION_IS_UTF8);
 }
 
+/**
+ * @brief Remove the delimiters and escapes added by quoted_str
+ *
+ * Inverse of quoted_str for the same delimiters, escape character and UTF-8 mode:
+ * for any string `s`, `unquoted_str(quoted_str(s), out)` succeeds and yields `s`
+ * (without a leading BOM, which quoted_str drops).
+ *
+ * @param s Quoted string
+ * @param out Receives the unescaped content; cleared when parsing fails
+ * @param start_delim Starting delimiter character
+ * @param end_delim Ending delimiter character
+ * @param escape Escape character, or '\0' when the string was quoted without escaping
+ * @param is_utf8 Whether multi-byte UTF-8 characters are copied without inspection
+ * @return false if `s` is not a well-formed quoted string
+ *
+ * @code{.cpp}
+ * std::string text;
+ * ustr::unquoted_str("\"say \\\"hi\\\"\"", text);         // true, text == "say \"hi\""
+ * ustr::unquoted_str("[a/]b]", text, '[', ']', '/');  // true, text == "a]b"
+ * ustr::unquoted_str("\"open", text);                 // false, text is empty
+ * @endcode
+ */
+inline bool unquoted_str(const std::string& s, std::string& out, char start_delim, char end_delim, char escape, bool is_utf8) {
+    out.clear();
+    if (!details::append_unquoted(out, s.data(), s.size(), start_delim, end_delim, escape, is_utf8)) {
+        out.clear();
+        return false;
+    }
+    return true;
+}
+
+inline bool unquoted_str(const std::string& s, std::string& out, char start_delim, char end_delim, char escape) {
+    return unquoted_str(s, out, start_delim, end_delim, escape, details::DEFAULT_QUOTATION_IS_UTF8);
+}
+
+inline bool unquoted_str(const std::string& s, std::string& out) {
+    return unquoted_str(s, out, details::DEFAULT_QUOTATION_DELIMITER, details::DEFAULT_QUOTATION_DELIMITER, details::DEFAULT_QUOTATION_ESCAPE_CHAR, details::DEFAULT_QUOTATION_IS_UTF8);
+}
+
 
 } // namespace ustr
 
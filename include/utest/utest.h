@@ -55,6 +55,28 @@
  * }
  * @endcode
  * 
+ * @section isolation_sec Process Isolation (POSIX)
+ * 
+ * With UTEST_ENABLE_ISOLATION() each test runs in a forked worker process, so a
+ * crashing or hanging test is reported as a failure instead of ending the run.
+ * Tests are queued by UTEST_FUNC/UTEST_FUNC2 and executed by UTEST_EPILOG(),
+ * optionally with a wall-clock limit and several workers at a time:
+ * 
+ * @code{.cpp}
+ * int main() {
+ *     UTEST_PROLOG();
+ *     UTEST_ENABLE_ISOLATION();
+ *     UTEST_SET_TEST_TIMEOUT_MS(5000);  // kill tests running longer than 5s
+ *     UTEST_SET_PARALLEL_JOBS(0);       // one worker per CPU
+ *     UTEST_FUNC2(Calculator, Addition);
+ *     UTEST_EPILOG();
+ * }
+ * @endcode
+ * 
+ * Results travel back over a pipe; output order follows completion order while
+ * the summary keeps registration order. On other platforms, or when UTEST_NO_FORK
+ * is defined, isolation settings are ignored and tests run in-process.
+ * 
  * @section features_sec Features
  * 
  * - **Header-only**: Just include utest.h and start testing
@@ -75,9 +97,25 @@
  * 
  * By default, ASCII checkmarks and performance timing are enabled for
  * better compatibility and useful debugging information.
+ *
+ * @section ustr_sec Integration with ustr
+ *
+ * When UTEST_USE_USTR is defined, utest.h includes ustr.h and values in
+ * assertion messages are converted with ustr::append_to, so containers,
+ * tuples, optionals and reflected structs are printed by value. Otherwise
+ * utest uses its own minimal conversions, whether or not ustr.h is included.
+ * Define the macro for the whole program (e.g. on the compiler command
+ * line), not per file: both variants define utest::details::convertToString.
  */
 
+#if defined(UTEST_USE_USTR)
+#include "../ustr/ustr.h"
+#endif
+
+#include <algorithm>
+#include <cstdio>
 #include <cstdlib>
+#include <cstring>
 #include <stdexcept>
 #include <string>
 #include <iostream>
@@ -88,6 +126,24 @@
 #include <chrono>
 #include <map>
 #include <iomanip>
+#include <iterator>
+#include <functional>
+#include <random>
+#if __cplusplus >= 201703L
+#include <string_view>
+#endif
+
+#if !defined(UTEST_NO_FORK) && (defined(__unix__) || defined(__APPLE__))
+#define UTEST_HAS_FORK_ 1
+#include <cerrno>
+#include <csignal>
+#include <poll.h>
+#include <sys/types.h>
+#include <sys/wait.h>
+#include <unistd.h>
+#else
+#define UTEST_HAS_FORK_ 0
+#endif
 
 // Cross-platform function name macro compatibility
 #ifndef __PRETTY_FUNCTION__
@@ -259,6 +315,47 @@ namespace details {
                      "UTEST_ASSERT_PTR_EQUALS can only be used with pointer types. Use UTEST_ASSERT_EQUALS for non-pointer comparisons.");
     }
 
+#if defined(__clang__) || defined(__GNUC__)
+#define UTEST_FUNCTION_SIGNATURE_ __PRETTY_FUNCTION__
+#elif defined(_MSC_VER)
+#define UTEST_FUNCTION_SIGNATURE_ __FUNCSIG__
+#endif
+
+#if defined(UTEST_FUNCTION_SIGNATURE_)
+    // Compiler signature of this function, which contains the name of T
+    template<typename T>
+    inline const char* typeSignature() {
+        return UTEST_FUNCTION_SIGNATURE_;
+    }
+#endif
+
+    // Readable name of T (instead of the mangled typeid name), computed once per type
+    template<typename T>
+    inline const std::string& typeName() {
+#if defined(UTEST_FUNCTION_SIGNATURE_)
+        static const std::string name = [] {
+            const std::string probe = typeSignature<int>();
+            const std::string signature = typeSignature<T>();
+            const std::size_t prefix = probe.find("int");
+            const std::size_t suffix = probe.size() - prefix - 3;
+            return signature.substr(prefix, signature.size() - prefix - suffix);
+        }();
+#else
+        static const std::string name = typeid(T).name();
+#endif
+        return name;
+    }
+
+#if defined(UTEST_USE_USTR)
+    // Conversion through ustr: one dispatch shared with the tested code,
+    // readable output for containers, tuples and other composite types
+    template<typename T>
+    inline std::string convertToString(const T& value) {
+        std::string out;
+        ustr::append_to(out, value);
+        return out;
+    }
+#else
     // For numeric types, use std::to_string
     template<typename T>
     inline typename std::enable_if<is_numeric<T>::value, std::string>::type
@@ -280,7 +377,7 @@ namespace details {
     inline typename std::enable_if<!is_numeric<T>::value && !is_streamable<T>::value, std::string>::type
     convertToString(const T& value) {
         std::ostringstream ss;
-        ss << "[" << typeid(T).name() << " at " << &value << "]";
+        ss << "[" << typeName<T>() << " at " << &value << "]";
         return ss.str();
     }
     
@@ -303,6 +400,7 @@ namespace details {
     inline std::string convertToString(char value) {
         return std::string(1, value);
     }
+#endif // UTEST_USE_USTR
 
   // Helper for conversion to std::string (handles std::string and const char*)
   inline std::string to_string_for_str_assert(const std::string& s) { return s; }
@@ -331,12 +429,225 @@ namespace details {
   template<typename T>
   inline std::string to_string_for_str_assert(const T& s) { return convertToString(s); }
 
-  // Helper for string contains check, always converts both arguments
+  // Non-owning view of a narrow string assertion argument, so comparisons on the
+  // success path do not allocate. Other types convertible to std::string are
+  // converted once and kept inside.
+  class str_ref {
+  public:
+    str_ref(const char* s) : data_(s ? s : ""), size_(s ? std::strlen(s) : 0), owned_(), owns_(false) {}
+    str_ref(const std::string& s) : data_(s.data()), size_(s.size()), owned_(), owns_(false) {}
+#if __cplusplus >= 201703L
+    str_ref(std::string_view s) : data_(s.data()), size_(s.size()), owned_(), owns_(false) {}
+#endif
+    template<typename T, typename = typename std::enable_if<
+      std::is_convertible<const T&, std::string>::value &&
+      !std::is_convertible<const T&, const char*>::value>::type>
+    str_ref(const T& value) : data_(nullptr), size_(0), owned_(value), owns_(true) {}
+
+    const char* data() const { return owns_ ? owned_.data() : data_; }
+    std::size_t size() const { return owns_ ? owned_.size() : size_; }
+
+  private:
+    const char* data_;
+    std::size_t size_;
+    std::string owned_;
+    bool owns_;
+  };
+
+  inline bool str_equals(const str_ref& a, const str_ref& b) {
+    return a.size() == b.size() && (a.size() == 0 || std::memcmp(a.data(), b.data(), a.size()) == 0);
+  }
+
+  inline bool str_find(const str_ref& str, const str_ref& substr) {
+    const char* end = str.data() + str.size();
+    return std::search(str.data(), end, substr.data(), substr.data() + substr.size()) != end ||
+           substr.size() == 0;
+  }
+
+  // Arguments that str_ref can view without converting
+  template<typename T>
+  struct is_narrow_str : std::integral_constant<bool,
+    std::is_convertible<const T&, const char*>::value ||
+    std::is_same<T, std::string>::value
+#if __cplusplus >= 201703L
+    || std::is_same<T, std::string_view>::value
+#endif
+  > {};
+
   template<typename S1, typename S2>
-  inline bool str_contains(const S1& str, const S2& substr) {
+  inline bool str_contains_impl(const S1& str, const S2& substr, std::true_type) {
+    return str_find(str, substr);
+  }
+
+  // Wide strings and other values are converted to std::string first
+  template<typename S1, typename S2>
+  inline bool str_contains_impl(const S1& str, const S2& substr, std::false_type) {
     return to_string_for_str_assert(str).find(to_string_for_str_assert(substr)) != std::string::npos;
   }
 
+  // Helper for string contains check
+  template<typename S1, typename S2>
+  inline bool str_contains(const S1& str, const S2& substr) {
+    return str_contains_impl(str, substr, std::integral_constant<bool,
+      is_narrow_str<S1>::value && is_narrow_str<S2>::value>());
+  }
+
+  // Failure reporting is kept out of line so assertion call sites stay small;
+  // messages are only formatted when an assertion fails.
+#if defined(__GNUC__) || defined(__clang__)
+#define UTEST_NOINLINE_ __attribute__((noinline))
+#elif defined(_MSC_VER)
+#define UTEST_NOINLINE_ __declspec(noinline)
+#else
+#define UTEST_NOINLINE_
+#endif
+
+  [[noreturn]] UTEST_NOINLINE_ inline void failAssertion(const std::string& message, const char* file, int line, const char* function) {
+    throw AssertionException(message, file, line, function);
+  }
+
+  [[noreturn]] UTEST_NOINLINE_ inline void failCondition(const char* prefix, const char* expression, const char* suffix,
+                                                         const char* file, int line, const char* function) {
+    failAssertion(std::string(prefix) + expression + suffix, file, line, function);
+  }
+
+  template<typename X, typename Y>
+  [[noreturn]] UTEST_NOINLINE_ void failCompare(const X& x, const Y& y, const char* relation,
+                                                const char* file, int line, const char* function) {
+    failAssertion("Assertion failed: " + convertToString(x) + " " + relation + " " + convertToString(y), file, line, function);
+  }
+
+  [[noreturn]] UTEST_NOINLINE_ inline void failPointerCompare(const void* x, const void* y, const char* relation,
+                                                              const char* file, int line, const char* function) {
+    std::ostringstream ss;
+    ss << "Pointer assertion failed: " << x << " " << relation << " " << y;
+    failAssertion(ss.str(), file, line, function);
+  }
+
+  [[noreturn]] UTEST_NOINLINE_ inline void failStrCompare(const str_ref& x, const str_ref& y, const char* relation,
+                                                          const char* file, int line, const char* function) {
+    std::string message = "String assertion failed: \"";
+    message.append(x.data(), x.size());
+    message += "\" ";
+    message += relation;
+    message += " \"";
+    message.append(y.data(), y.size());
+    message += "\"";
+    failAssertion(message, file, line, function);
+  }
+
+  template<typename S1, typename S2>
+  [[noreturn]] UTEST_NOINLINE_ void failStrContains(const S1& str, const S2& substr, const char* relation,
+                                                    const char* file, int line, const char* function) {
+    failAssertion("String assertion failed: \"" + to_string_for_str_assert(str) + "\" " + relation +
+                  " \"" + to_string_for_str_assert(substr) + "\"", file, line, function);
+  }
+
+  // Number of elements shown on each side of the first mismatch in container assertions
+#ifndef UTEST_CONTAINER_DIFF_CONTEXT
+#define UTEST_CONTAINER_DIFF_CONTEXT 3
+#endif
+
+  // Detects containers with contiguous data()/size()
+  template<typename T>
+  class has_data_size {
+    template<typename TT>
+    static decltype(std::declval<const TT&>().data(), std::declval<const TT&>().size(), std::true_type()) test(int);
+    template<typename>
+    static std::false_type test(...);
+  public:
+    static const bool value = decltype(test<T>(0))::value;
+  };
+
+  template<typename C>
+  struct container_element {
+    typedef typename std::decay<decltype(*std::begin(std::declval<const C&>()))>::type type;
+  };
+
+  // Elements that are equal exactly when their bytes are equal (no padding, no NaN or -0.0)
+  template<typename C1, typename C2,
+           typename T1 = typename container_element<C1>::type,
+           typename T2 = typename container_element<C2>::type>
+  struct is_bytewise_comparable : std::integral_constant<bool,
+    has_data_size<C1>::value && has_data_size<C2>::value &&
+    std::is_same<T1, T2>::value &&
+    (std::is_integral<T1>::value || std::is_enum<T1>::value || std::is_pointer<T1>::value)> {};
+
+  // Index of the first differing element; for contiguous integral data whole blocks
+  // are compared with memcmp and only the differing block is scanned
+  template<typename C1, typename C2>
+  inline std::size_t findFirstMismatch(const C1& a, const C2& b, std::true_type) {
+    typedef typename container_element<C1>::type element_type;
+    const std::size_t size = std::min(static_cast<std::size_t>(a.size()), static_cast<std::size_t>(b.size()));
+    const element_type* pa = a.data();
+    const element_type* pb = b.data();
+    const std::size_t block_size = 1024;
+    for (std::size_t i = 0; i < size; i += block_size) {
+      const std::size_t count = std::min(block_size, size - i);
+      if (std::memcmp(pa + i, pb + i, count * sizeof(element_type)) != 0) {
+        return i + static_cast<std::size_t>(std::mismatch(pa + i, pa + i + count, pb + i).first - (pa + i));
+      }
+    }
+    return size;
+  }
+
+  template<typename C1, typename C2>
+  inline std::size_t findFirstMismatch(const C1& a, const C2& b, std::false_type) {
+    std::size_t index = 0;
+    auto ia = std::begin(a);
+    auto ib = std::begin(b);
+    for (; ia != std::end(a) && ib != std::end(b); ++ia, ++ib, ++index) {
+      if (!(*ia == *ib)) {
+        break;
+      }
+    }
+    return index;
+  }
+
+  // Formats elements [first, last) of a container, e.g. "[4, 5, 6]"
+  template<typename C>
+  inline std::string formatContainerWindow(const C& c, std::size_t first, std::size_t last) {
+    std::string out = "[";
+    auto it = std::begin(c);
+    std::advance(it, static_cast<typename std::iterator_traits<decltype(it)>::difference_type>(first));
+    for (std::size_t i = first; i < last; ++i, ++it) {
+      if (i != first) {
+        out += ", ";
+      }
+      out += convertToString(*it);
+    }
+    out += "]";
+    return out;
+  }
+
+  inline std::string formatWindowLabel(const char* name, std::size_t first, std::size_t last) {
+    std::ostringstream ss;
+    ss << name << "[" << first << ".." << last << ")";
+    return ss.str();
+  }
+
+  // Returns an empty string when the containers are equal, otherwise a message showing
+  // only a bounded window around the first mismatch (containers are never formatted in full)
+  template<typename C1, typename C2>
+  inline std::string describeContainerMismatch(const C1& a, const C2& b, const char* name_a, const char* name_b) {
+    const std::size_t size_a = static_cast<std::size_t>(std::distance(std::begin(a), std::end(a)));
+    const std::size_t size_b = static_cast<std::size_t>(std::distance(std::begin(b), std::end(b)));
+    const std::size_t index = findFirstMismatch(a, b, typename is_bytewise_comparable<C1, C2>::type());
+    if (index == size_a && index == size_b) {
+      return std::string();
+    }
+    const std::size_t context = UTEST_CONTAINER_DIFF_CONTEXT;
+    const std::size_t first = index > context ? index - context : 0;
+    const std::size_t last_a = std::min(size_a, index + context + 1);
+    const std::size_t last_b = std::min(size_b, index + context + 1);
+    std::ostringstream ss;
+    ss << "containers differ at index " << index
+       << " (sizes " << size_a << " and " << size_b << "): "
+       << formatWindowLabel(name_a, first, last_a) << " = " << formatContainerWindow(a, first, last_a) << ", "
+       << formatWindowLabel(name_b, first, last_b) << " = " << formatContainerWindow(b, first, last_b);
+    return ss.str();
+  }
+
 }
 
 /**
@@ -366,14 +677,12 @@ namespace details {
  * UTEST_ASSERT_TRUE(ptr != nullptr);
  * @endcode
  */
-#define UTEST_ASSERT_TRUE( condition )                             \
-{                                                                   \
-  if( !( condition ) )                                              \
-  {                                                                 \
-    std::ostringstream ss;                                          \
-    ss << "condition is false: '" << (#condition) << "'";           \
-    throw utest::AssertionException(ss.str(), __FILE__, __LINE__, __PRETTY_FUNCTION__); \
-  }                                                                 \
+#define UTEST_ASSERT_TRUE( condition )                           \
+{                                                                 \
+  if( !( condition ) )                                            \
+  {                                                               \
+    utest::details::failCondition("condition is false: '", #condition, "'", __FILE__, __LINE__, __PRETTY_FUNCTION__); \
+  }                                                               \
 }
 
 /**
@@ -408,14 +717,12 @@ namespace details {
  * UTEST_ASSERT_FALSE(list.empty());
  * @endcode
  */
-#define UTEST_ASSERT_FALSE( condition )                            \
-{                                                                   \
-  if( ( condition ) )                                               \
-  {                                                                 \
-    std::ostringstream ss;                                          \
-    ss << "condition is true: '" << (#condition) << "'";            \
-    throw utest::AssertionException(ss.str(), __FILE__, __LINE__, __PRETTY_FUNCTION__); \
-  }                                                                 \
+#define UTEST_ASSERT_FALSE( condition )                          \
+{                                                                 \
+  if( ( condition ) )                                             \
+  {                                                               \
+    utest::details::failCondition("condition is true: '", #condition, "'", __FILE__, __LINE__, __PRETTY_FUNCTION__); \
+  }                                                               \
 }
 
 /**
@@ -454,16 +761,13 @@ namespace details {
  * UTEST_ASSERT_EQUALS(std::string("hello"), "hello");
  * @endcode
  */
-#define UTEST_ASSERT_EQUALS( x, y )                                \
-{                                                                   \
+#define UTEST_ASSERT_EQUALS( x, y )                              \
+{                                                                 \
   utest::details::check_not_pointer_types<decltype(x), decltype(y)>(); \
-  if( ( x ) != ( y ) )                                              \
-  {                                                                 \
-    std::ostringstream ss;                                          \
-    ss << "Assertion failed: " << UTEST_TO_STRING( ( x ) )          \
-       << " != " << UTEST_TO_STRING( ( y ) );                       \
-    throw utest::AssertionException(ss.str(), __FILE__, __LINE__, __PRETTY_FUNCTION__); \
-  }                                                                 \
+  if( ( x ) != ( y ) )                                            \
+  {                                                               \
+    utest::details::failCompare( ( x ), ( y ), "!=", __FILE__, __LINE__, __PRETTY_FUNCTION__); \
+  }                                                               \
 }
 
 /**
@@ -505,16 +809,13 @@ namespace details {
  * UTEST_ASSERT_PTR_EQUALS(p1, p2);
  * @endcode
  */
-#define UTEST_ASSERT_PTR_EQUALS( ptr1, ptr2 )                      \
-{                                                                   \
+#define UTEST_ASSERT_PTR_EQUALS( ptr1, ptr2 )                    \
+{                                                                 \
   utest::details::check_only_pointer_types<decltype(ptr1), decltype(ptr2)>(); \
-  if( ( ptr1 ) != ( ptr2 ) )                                       \
-  {                                                                 \
-    std::ostringstream ss;                                          \
-    ss << "Pointer assertion failed: " << reinterpret_cast<const void*>( ptr1 ) \
-       << " != " << reinterpret_cast<const void*>( ptr2 );               \
-    throw utest::AssertionException(ss.str(), __FILE__, __LINE__, __PRETTY_FUNCTION__); \
-  }                                                                 \
+  if( ( ptr1 ) != ( ptr2 ) )                                      \
+  {                                                               \
+    utest::details::failPointerCompare(reinterpret_cast<const void*>( ptr1 ), reinterpret_cast<const void*>( ptr2 ), "!=", __FILE__, __LINE__, __PRETTY_FUNCTION__); \
+  }                                                               \
 }
 
 /**
@@ -554,15 +855,12 @@ namespace details {
  * UTEST_ASSERT_PTR_NOT_EQUALS(p1, p2);
  * @endcode
  */
-#define UTEST_ASSERT_PTR_NOT_EQUALS( ptr1, ptr2 )                  \
-{                                                                   \
-  if( ( ptr1 ) == ( ptr2 ) )                                       \
-  {                                                                 \
-    std::ostringstream ss;                                          \
-    ss << "Pointer assertion failed: " << reinterpret_cast<const void*>( ptr1 ) \
-       << " == " << reinterpret_cast<const void*>( ptr2 );          \
-    throw utest::AssertionException(ss.str(), __FILE__, __LINE__, __PRETTY_FUNCTION__); \
-  }                                                                 \
+#define UTEST_ASSERT_PTR_NOT_EQUALS( ptr1, ptr2 )                \
+{                                                                 \
+  if( ( ptr1 ) == ( ptr2 ) )                                      \
+  {                                                               \
+    utest::details::failPointerCompare(reinterpret_cast<const void*>( ptr1 ), reinterpret_cast<const void*>( ptr2 ), "==", __FILE__, __LINE__, __PRETTY_FUNCTION__); \
+  }                                                               \
 }
 
 /**
@@ -599,14 +897,12 @@ namespace details {
  * UTEST_ASSERT_NULL(object.getOptionalResource());
  * @endcode
  */
-#define UTEST_ASSERT_NULL( ptr )                                   \
-{                                                                   \
-  if( ( ptr ) != nullptr )                                          \
-  {                                                                 \
-    std::ostringstream ss;                                          \
-    ss << "Assertion failed, pointer is not null: " << (#ptr);      \
-    throw utest::AssertionException(ss.str(), __FILE__, __LINE__, __PRETTY_FUNCTION__); \
-  }                                                                 \
+#define UTEST_ASSERT_NULL( ptr )                                 \
+{                                                                 \
+  if( ( ptr ) != nullptr )                                        \
+  {                                                               \
+    utest::details::failCondition("Assertion failed, pointer is not null: ", #ptr, "", __FILE__, __LINE__, __PRETTY_FUNCTION__); \
+  }                                                               \
 }
 
 /**
@@ -620,49 +916,38 @@ namespace details {
  * UTEST_ASSERT_NOT_NULL(factory.createObject());
  * @endcode
  */
-#define UTEST_ASSERT_NOT_NULL( ptr )                               \
-{                                                                   \
-  if( ( ptr ) == nullptr )                                          \
-  {                                                                 \
-    std::ostringstream ss;                                          \
-    ss << "Assertion failed, pointer is null: '" << (#ptr) << "'";  \
-    throw utest::AssertionException(ss.str(), __FILE__, __LINE__, __PRETTY_FUNCTION__); \
-  }                                                                 \
+#define UTEST_ASSERT_NOT_NULL( ptr )                             \
+{                                                                 \
+  if( ( ptr ) == nullptr )                                        \
+  {                                                               \
+    utest::details::failCondition("Assertion failed, pointer is null: '", #ptr, "'", __FILE__, __LINE__, __PRETTY_FUNCTION__); \
+  }                                                               \
 }
 
 // New assertion macros
 
-#define UTEST_ASSERT_NOT_EQUALS( x, y )                            \
-{                                                                   \
-  if( ( x ) == ( y ) )                                              \
-  {                                                                 \
-    std::ostringstream ss;                                          \
-    ss << "Assertion failed: " << UTEST_TO_STRING( ( x ) )          \
-       << " == " << UTEST_TO_STRING( ( y ) );                       \
-    throw utest::AssertionException(ss.str(), __FILE__, __LINE__, __PRETTY_FUNCTION__); \
-  }                                                                 \
+#define UTEST_ASSERT_NOT_EQUALS( x, y )                          \
+{                                                                 \
+  if( ( x ) == ( y ) )                                            \
+  {                                                               \
+    utest::details::failCompare( ( x ), ( y ), "==", __FILE__, __LINE__, __PRETTY_FUNCTION__); \
+  }                                                               \
 }
 
-#define UTEST_ASSERT_STR_EQUALS( x, y )                            \
-{                                                                   \
-  if( std::string( x ) != std::string( y ) )                       \
-  {                                                                 \
-    std::ostringstream ss;                                          \
-    ss << "String assertion failed: \"" << std::string( x )         \
-       << "\" != \"" << std::string( y ) << "\"";                   \
-    throw utest::AssertionException(ss.str(), __FILE__, __LINE__, __PRETTY_FUNCTION__); \
-  }                                                                 \
+#define UTEST_ASSERT_STR_EQUALS( x, y )                          \
+{                                                                 \
+  if( !utest::details::str_equals( ( x ), ( y ) ) )               \
+  {                                                               \
+    utest::details::failStrCompare( ( x ), ( y ), "!=", __FILE__, __LINE__, __PRETTY_FUNCTION__); \
+  }                                                               \
 }
 
-#define UTEST_ASSERT_STR_NOT_EQUALS( x, y )                        \
-{                                                                   \
-  if( std::string( x ) == std::string( y ) )                       \
-  {                                                                 \
-    std::ostringstream ss;                                          \
-    ss << "String assertion failed: \"" << std::string( x )         \
-       << "\" == \"" << std::string( y ) << "\"";                   \
-    throw utest::AssertionException(ss.str(), __FILE__, __LINE__, __PRETTY_FUNCTION__); \
-  }                                                                 \
+#define UTEST_ASSERT_STR_NOT_EQUALS( x, y )                      \
+{                                                                 \
+  if( utest::details::str_equals( ( x ), ( y ) ) )                \
+  {                                                               \
+    utest::details::failStrCompare( ( x ), ( y ), "==", __FILE__, __LINE__, __PRETTY_FUNCTION__); \
+  }                                                               \
 }
 
 /**
@@ -678,17 +963,12 @@ namespace details {
  * @endcode
  */
 
-#define UTEST_ASSERT_STR_CONTAINS( a_string, a_substr )                                   \
-{                                                                                  \
-  if( !utest::details::str_contains(a_string, a_substr) )                                 \
-  {                                                                                \
-    std::string _utest_str = utest::details::to_string_for_str_assert(a_string);        \
-    std::string _utest_substr = utest::details::to_string_for_str_assert(a_substr);  \
-    std::ostringstream ss;                                                         \
-    ss << "String assertion failed: \"" << _utest_str                              \
-      << "\" does not contain \"" << _utest_substr << "\"";                       \
-    throw utest::AssertionException(ss.str(), __FILE__, __LINE__, __PRETTY_FUNCTION__); \
-  }                                                                                \
+#define UTEST_ASSERT_STR_CONTAINS( a_string, a_substr )          \
+{                                                                 \
+  if( !utest::details::str_contains(a_string, a_substr) )         \
+  {                                                               \
+    utest::details::failStrContains(a_string, a_substr, "does not contain", __FILE__, __LINE__, __PRETTY_FUNCTION__); \
+  }                                                               \
 }
 
 /**
@@ -703,61 +983,44 @@ namespace details {
  * UTEST_ASSERT_STR_NOT_CONTAINS(response, "failure");
  * @endcode
  */
-#define UTEST_ASSERT_STR_NOT_CONTAINS( a_string, a_substr )               \
-{                                                                   \
-  if( utest::details::str_contains(a_string, a_substr) )                                 \
-  {                                                                 \
-    std::string _utest_str = utest::details::to_string_for_str_assert(a_string);        \
-    std::string _utest_substr = utest::details::to_string_for_str_assert(a_substr);      \
-    std::ostringstream ss;                                          \
-    ss << "String assertion failed: \"" << _utest_str               \
-       << "\" contains \"" << _utest_substr << "\"";                \
-    throw utest::AssertionException(ss.str(), __FILE__, __LINE__, __PRETTY_FUNCTION__); \
-  }                                                                 \
+#define UTEST_ASSERT_STR_NOT_CONTAINS( a_string, a_substr )      \
+{                                                                 \
+  if( utest::details::str_contains(a_string, a_substr) )          \
+  {                                                               \
+    utest::details::failStrContains(a_string, a_substr, "contains", __FILE__, __LINE__, __PRETTY_FUNCTION__); \
+  }                                                               \
 }
 
-#define UTEST_ASSERT_GT( x, y )                                    \
-{                                                                   \
-  if( !( ( x ) > ( y ) ) )                                          \
-  {                                                                 \
-    std::ostringstream ss;                                          \
-    ss << "Assertion failed: " << UTEST_TO_STRING( ( x ) )          \
-       << " is not greater than " << UTEST_TO_STRING( ( y ) );      \
-    throw utest::AssertionException(ss.str(), __FILE__, __LINE__, __PRETTY_FUNCTION__); \
-  }                                                                 \
+#define UTEST_ASSERT_GT( x, y )                                  \
+{                                                                 \
+  if( !( ( x ) > ( y ) ) )                                        \
+  {                                                               \
+    utest::details::failCompare( ( x ), ( y ), "is not greater than", __FILE__, __LINE__, __PRETTY_FUNCTION__); \
+  }                                                               \
 }
 
-#define UTEST_ASSERT_GTE( x, y )                                   \
-{                                                                   \
-  if( !( ( x ) >= ( y ) ) )                                         \
-  {                                                                 \
-    std::ostringstream ss;                                          \
-    ss << "Assertion failed: " << UTEST_TO_STRING( ( x ) )          \
-       << " is not greater than or equal to " << UTEST_TO_STRING( ( y ) ); \
-    throw utest::AssertionException(ss.str(), __FILE__, __LINE__, __PRETTY_FUNCTION__); \
-  }                                                                 \
+#define UTEST_ASSERT_GTE( x, y )                                 \
+{                                                                 \
+  if( !( ( x ) >= ( y ) ) )                                       \
+  {                                                               \
+    utest::details::failCompare( ( x ), ( y ), "is not greater than or equal to", __FILE__, __LINE__, __PRETTY_FUNCTION__); \
+  }                                                               \
 }
 
-#define UTEST_ASSERT_LT( x, y )                                    \
-{                                                                   \
-  if( !( ( x ) < ( y ) ) )                                          \
-  {                                                                 \
-    std::ostringstream ss;                                          \
-    ss << "Assertion failed: " << UTEST_TO_STRING( ( x ) )          \
-       << " is not less than " << UTEST_TO_STRING( ( y ) );         \
-    throw utest::AssertionException(ss.str(), __FILE__, __LINE__, __PRETTY_FUNCTION__); \
-  }                                                                 \
+#define UTEST_ASSERT_LT( x, y )                                  \
+{                                                                 \
+  if( !( ( x ) < ( y ) ) )                                        \
+  {                                                               \
+    utest::details::failCompare( ( x ), ( y ), "is not less than", __FILE__, __LINE__, __PRETTY_FUNCTION__); \
+  }                                                               \
 }
 
-#define UTEST_ASSERT_LTE( x, y )                                   \
-{                                                                   \
-  if( !( ( x ) <= ( y ) ) )                                         \
-  {                                                                 \
-    std::ostringstream ss;                                          \
-    ss << "Assertion failed: " << UTEST_TO_STRING( ( x ) )          \
-       << " is not less than or equal to " << UTEST_TO_STRING( ( y ) ); \
-    throw utest::AssertionException(ss.str(), __FILE__, __LINE__, __PRETTY_FUNCTION__); \
-  }                                                                 \
+#define UTEST_ASSERT_LTE( x, y )                                 \
+{                                                                 \
+  if( !( ( x ) <= ( y ) ) )                                       \
+  {                                                               \
+    utest::details::failCompare( ( x ), ( y ), "is not less than or equal to", __FILE__, __LINE__, __PRETTY_FUNCTION__); \
+  }                                                               \
 }
 
 // MSG versions for all assertion macros
@@ -775,7 +1038,7 @@ namespace details {
 
 #define UTEST_ASSERT_STR_EQUALS_MSG( x, y, msg )                   \
 {                                                                   \
-  if( std::string( x ) != std::string( y ) )                       \
+  if( !utest::details::str_equals( ( x ), ( y ) ) )                \
   {                                                                 \
     std::ostringstream ss;                                          \
     ss << "String assertion failed, '" << msg << "': \""            \
@@ -786,7 +1049,7 @@ namespace details {
 
 #define UTEST_ASSERT_STR_NOT_EQUALS_MSG( x, y, msg )               \
 {                                                                   \
-  if( std::string( x ) == std::string( y ) )                       \
+  if( utest::details::str_equals( ( x ), ( y ) ) )                 \
   {                                                                 \
     std::ostringstream ss;                                          \
     ss << "String assertion failed, '" << msg << "': \""            \
@@ -913,6 +1176,44 @@ namespace details {
   }                                                                 \
 }
 
+/**
+ * @brief Assert that two containers have equal elements
+ * @param x First container
+ * @param y Second container
+ *
+ * Locates the first mismatching element (using memcmp for contiguous
+ * integral data) and reports only UTEST_CONTAINER_DIFF_CONTEXT elements
+ * around it, so failures on large containers stay fast and short.
+ * Containers of different types can be compared if their elements are.
+ *
+ * @code{.cpp}
+ * UTEST_ASSERT_CONTAINER_EQUALS(result, expected);
+ * // containers differ at index 500000 (sizes 1000000 and 1000000):
+ * //   result[499997..500001) = [...], expected[499997..500001) = [...]
+ * @endcode
+ */
+#define UTEST_ASSERT_CONTAINER_EQUALS( x, y )                      \
+{                                                                   \
+  const std::string utest_mismatch_ =                               \
+    utest::details::describeContainerMismatch( ( x ), ( y ), #x, #y ); \
+  if( !utest_mismatch_.empty() )                                    \
+  {                                                                 \
+    throw utest::AssertionException("Assertion failed: " + utest_mismatch_, __FILE__, __LINE__, __PRETTY_FUNCTION__); \
+  }                                                                 \
+}
+
+#define UTEST_ASSERT_CONTAINER_EQUALS_MSG( x, y, msg )             \
+{                                                                   \
+  const std::string utest_mismatch_ =                               \
+    utest::details::describeContainerMismatch( ( x ), ( y ), #x, #y ); \
+  if( !utest_mismatch_.empty() )                                    \
+  {                                                                 \
+    std::ostringstream ss;                                          \
+    ss << "Assertion failed, '" << msg << "': " << utest_mismatch_; \
+    throw utest::AssertionException(ss.str(), __FILE__, __LINE__, __PRETTY_FUNCTION__); \
+  }                                                                 \
+}
+
 /**
  * @defgroup aliases Convenient Aliases
  * @brief Short aliases for commonly used assertion macros
@@ -1018,69 +1319,281 @@ namespace details {
         return verbose;
     }
     
-    template<typename Func>
-    void testFunc(const char *name, Func f, bool &failed) {
+    // Configuration for running each test in a forked worker process (POSIX only)
+    inline bool& getIsolationMode() {
+        static bool isolate = false;  // Default to running tests in-process
+        return isolate;
+    }
+    
+    // Wall-clock limit for isolated tests in milliseconds, 0 means no limit
+    inline long& getTestTimeoutMs() {
+        static long timeoutMs = 0;
+        return timeoutMs;
+    }
+    
+    // Number of isolated tests running at the same time, 0 means one per CPU
+    inline unsigned& getParallelJobs() {
+        static unsigned jobs = 1;
+        return jobs;
+    }
+    
+    // Test queued for isolated execution by UTEST_EPILOG
+    struct PendingTest {
         TestResult result;
-        result.name = name;
-        result.name = name;
-        result.group = ""; // No group for single tests
-        result.passed = true;
-        result.elapsedTime = 0.0;
-        
-        // Get checkmark symbols
-        const char* successMark = getUseAsciiCheckmarks() ? "[OK]" : "✓";
-        const char* failMark = getUseAsciiCheckmarks() ? "[FAIL]" : "✗";
+        std::function<void()> body;
+    };
+    
+    inline std::vector<PendingTest>& getPendingTests() {
+        static std::vector<PendingTest> pending;
+        return pending;
+    }
+    
+    inline std::string testDisplayName(const TestResult& result) {
+        return result.group.empty() ? result.name : result.group + "::" + result.name;
+    }
+    
+    // Test selection and ordering options set from the command line (see UTEST_PROLOG)
+    struct RunOptions {
+        std::vector<std::string> filters;  // --filter patterns, empty runs everything
+        unsigned long repeat;              // --repeat count
+        unsigned long shardIndex;          // --shard=index/count
+        unsigned long shardCount;
+        bool shuffle;                      // --shuffle[=seed]
+        unsigned long seed;
+        unsigned long selected;            // tests selected so far, used for sharding
         
-        // Show test name before execution if verbose mode is enabled
-        if (getVerboseMode()) {
-            std::cout << "Running test: " << std::string(name) << "\n";
+        RunOptions() : repeat(1), shardIndex(0), shardCount(1), shuffle(false), seed(0), selected(0) {}
+    };
+    
+    inline RunOptions& getRunOptions() {
+        static RunOptions options;
+        return options;
+    }
+    
+    // Glob match supporting '*' (any sequence) and '?' (any character)
+    inline bool wildcardMatch(const char* pattern, const char* text) {
+        const char* starPattern = nullptr;
+        const char* starText = nullptr;
+        while (*text) {
+            if (*pattern == '*') {
+                starPattern = pattern++;
+                starText = text;
+            } else if (*pattern == '?' || *pattern == *text) {
+                ++pattern;
+                ++text;
+            } else if (starPattern) {
+                pattern = starPattern + 1;
+                text = ++starText;
+            } else {
+                return false;
+            }
         }
-        
+        while (*pattern == '*') {
+            ++pattern;
+        }
+        return *pattern == '\0';
+    }
+    
+    // Applies --filter and --shard; patterns without "::" also match whole groups
+    inline bool isTestSelected(const TestResult& result) {
+        RunOptions& options = getRunOptions();
+        if (!options.filters.empty()) {
+            const std::string name = testDisplayName(result);
+            bool matched = false;
+            for (const auto& pattern : options.filters) {
+                if (wildcardMatch(pattern.c_str(), name.c_str()) ||
+                    (pattern.find("::") == std::string::npos && wildcardMatch(pattern.c_str(), result.group.c_str()))) {
+                    matched = true;
+                    break;
+                }
+            }
+            if (!matched) {
+                return false;
+            }
+        }
+        return options.selected++ % options.shardCount == options.shardIndex;
+    }
+    
+    inline bool parseUnsigned(const std::string& text, unsigned long& value) {
+        if (text.empty() || text[0] < '0' || text[0] > '9') {
+            return false;
+        }
+        char* end = nullptr;
+        value = std::strtoul(text.c_str(), &end, 10);
+        return *end == '\0';
+    }
+    
+    inline bool hasPrefix(const std::string& arg, const char* prefix, std::string& value) {
+        const std::size_t length = std::strlen(prefix);
+        if (arg.compare(0, length, prefix) != 0) {
+            return false;
+        }
+        value = arg.substr(length);
+        return true;
+    }
+    
+    inline void parseCommandLine() {
+    }
+    
+    // Parses --filter, --repeat, --shard, --shuffle, --verbose, --isolate, --jobs and --timeout
+    inline void parseCommandLine(int argc, const char* const* argv) {
+        RunOptions& options = getRunOptions();
+        for (int i = 1; i < argc; ++i) {
+            const std::string arg = argv[i];
+            std::string value;
+            unsigned long number = 0;
+            bool valid = true;
+            
+            if (hasPrefix(arg, "--filter=", value)) {
+                std::istringstream patterns(value);
+                std::string pattern;
+                while (std::getline(patterns, pattern, ',')) {
+                    if (!pattern.empty()) {
+                        options.filters.push_back(pattern);
+                    }
+                }
+                // Binaries without matching tests must not fail a filtered run
+                getAllowEmptyTests() = true;
+            } else if (hasPrefix(arg, "--repeat=", value)) {
+                valid = parseUnsigned(value, number) && number > 0;
+                if (valid) {
+                    options.repeat = number;
+                }
+            } else if (hasPrefix(arg, "--shard=", value)) {
+                const std::size_t slash = value.find('/');
+                unsigned long count = 0;
+                valid = slash != std::string::npos &&
+                        parseUnsigned(value.substr(0, slash), number) &&
+                        parseUnsigned(value.substr(slash + 1), count) && number < count;
+                if (valid) {
+                    options.shardIndex = number;
+                    options.shardCount = count;
+                    getAllowEmptyTests() = true;
+                }
+            } else if (arg == "--shuffle") {
+                options.shuffle = true;
+                options.seed = static_cast<unsigned long>(
+                    std::chrono::high_resolution_clock::now().time_since_epoch().count());
+            } else if (hasPrefix(arg, "--shuffle=", value)) {
+                valid = parseUnsigned(value, number);
+                if (valid) {
+                    options.shuffle = true;
+                    options.seed = number;
+                }
+            } else if (arg == "--verbose") {
+                getVerboseMode() = true;
+            } else if (arg == "--isolate") {
+                getIsolationMode() = true;
+            } else if (hasPrefix(arg, "--jobs=", value)) {
+                valid = parseUnsigned(value, number);
+                if (valid) {
+                    getParallelJobs() = static_cast<unsigned>(number);
+                }
+            } else if (hasPrefix(arg, "--timeout=", value)) {
+                valid = parseUnsigned(value, number);
+                if (valid) {
+                    getTestTimeoutMs() = static_cast<long>(number);
+                }
+            } else {
+                valid = false;
+            }
+            
+            if (!valid) {
+                std::cerr << "utest: ignoring unknown or invalid option '" << arg << "'\n";
+            }
+        }
+    }
+    
+    // Runs a test body, storing status, error and elapsed time in result.
+    // unexpected is set for exceptions other than AssertionException.
+    template<typename Func>
+    void executeTestBody(Func& f, TestResult& result, bool& unexpected) {
+        unexpected = false;
         auto start = std::chrono::high_resolution_clock::now();
         
         try {
             f();
-            auto end = std::chrono::high_resolution_clock::now();
-            auto duration = std::chrono::duration_cast<std::chrono::microseconds>(end - start);
-            result.elapsedTime = static_cast<double>(duration.count()) / 1000.0; // Convert to milliseconds
-            
-            std::cout << successMark << " Test [" << std::string(name) << "] succeeded";
-            if (getShowPerformanceInfo()) {
-                std::cout << " (" << std::fixed << std::setprecision(3) << result.elapsedTime << "ms)";
-            }
-            std::cout << "\n";
         }
         catch (const AssertionException &e) {
-            auto end = std::chrono::high_resolution_clock::now();
-            auto duration = std::chrono::duration_cast<std::chrono::microseconds>(end - start);
-            result.elapsedTime = static_cast<double>(duration.count()) / 1000.0;
-            
-            std::cout << failMark << " Test [" << std::string(name) << "] failed!, error: " << e.getFormattedMessage();
-            if (getShowPerformanceInfo()) {
-                std::cout << " (" << std::fixed << std::setprecision(3) << result.elapsedTime << "ms)";
-            }
-            std::cout << "\n";
-            failed = true;
             result.passed = false;
             result.error = e.getFormattedMessage();
         }
         catch (std::exception &e) {
-            auto end = std::chrono::high_resolution_clock::now();
-            auto duration = std::chrono::duration_cast<std::chrono::microseconds>(end - start);
-            result.elapsedTime = static_cast<double>(duration.count()) / 1000.0;
-            
-            std::cout << failMark << " Test [" << std::string(name) << "] failed with unexpected exception!, error: " << e.what();
-            if (getShowPerformanceInfo()) {
-                std::cout << " (" << std::fixed << std::setprecision(3) << result.elapsedTime << "ms)";
-            }
-            std::cout << "\n";
-            failed = true;
             result.passed = false;
             result.error = e.what();
+            unexpected = true;
+        }
+        
+        auto end = std::chrono::high_resolution_clock::now();
+        auto duration = std::chrono::duration_cast<std::chrono::microseconds>(end - start);
+        result.elapsedTime = static_cast<double>(duration.count()) / 1000.0; // Convert to milliseconds
+    }
+    
+    inline void reportTestOutcome(const TestResult& result, bool unexpected) {
+        // Get checkmark symbols
+        const char* successMark = getUseAsciiCheckmarks() ? "[OK]" : "✓";
+        const char* failMark = getUseAsciiCheckmarks() ? "[FAIL]" : "✗";
+        
+        if (result.passed) {
+            std::cout << successMark << " Test [" << testDisplayName(result) << "] succeeded";
+        } else {
+            std::cout << failMark << " Test [" << testDisplayName(result) << "] failed"
+                      << (unexpected ? " with unexpected exception" : "") << "!, error: " << result.error;
+        }
+        if (getShowPerformanceInfo()) {
+            std::cout << " (" << std::fixed << std::setprecision(3) << result.elapsedTime << "ms)";
+        }
+        std::cout << "\n";
+    }
+    
+    // Runs a test in this process and records its result
+    template<typename Func>
+    void runTestNow(TestResult result, Func& f, bool &failed) {
+        // Show test name before execution if verbose mode is enabled
+        if (getVerboseMode()) {
+            std::cout << "Running test: " << testDisplayName(result) << "\n";
+        }
+        
+        bool unexpected = false;
+        executeTestBody(f, result, unexpected);
+        reportTestOutcome(result, unexpected);
+        if (!result.passed) {
+            failed = true;
         }
         
         getTestResults().push_back(result);
     }
+    
+    // Runs a selected test right away, or queues it for UTEST_EPILOG when
+    // tests are isolated or shuffled
+    template<typename Func>
+    void runTest(TestResult& result, Func f, bool &failed) {
+        if (!isTestSelected(result)) {
+            return;
+        }
+        const RunOptions& options = getRunOptions();
+        const bool deferred = (UTEST_HAS_FORK_ && getIsolationMode()) || options.shuffle;
+        for (unsigned long i = 0; i < options.repeat; ++i) {
+            if (deferred) {
+                PendingTest pending;
+                pending.result = result;
+                pending.body = f;
+                getPendingTests().push_back(pending);
+            } else {
+                runTestNow(result, f, failed);
+            }
+        }
+    }
+    
+    template<typename Func>
+    void testFunc(const char *name, Func f, bool &failed) {
+        TestResult result;
+        result.name = name;
+        result.group = ""; // No group for single tests
+        result.passed = true;
+        result.elapsedTime = 0.0;
+        runTest(result, f, failed);
+    }
 
     // Overloaded version for grouped tests (UTEST_FUNC2)
     template<typename Func>
@@ -1090,60 +1603,282 @@ namespace details {
         result.group = group;
         result.passed = true;
         result.elapsedTime = 0.0;
+        runTest(result, f, failed);
+    }
+
+    // Test defined with UTEST_FUNC_DEF/UTEST_FUNC_DEF2, kept in definition order
+    struct RegisteredTest {
+        const char* group;  // Empty for UTEST_FUNC_DEF tests
+        const char* name;
+        void (*body)();
+    };
+    
+    inline std::vector<RegisteredTest>& getRegisteredTests() {
+        static std::vector<RegisteredTest> registered;
+        return registered;
+    }
+    
+    // Static object created next to each test definition to register it
+    struct TestRegistrar {
+        TestRegistrar(const char* group, const char* name, void (*body)()) {
+            RegisteredTest test = {group, name, body};
+            getRegisteredTests().push_back(test);
+        }
+    };
+    
+    // Runs every test defined in the binary (UTEST_RUN_REGISTERED)
+    inline void runRegisteredTests(bool &failed) {
+        for (const auto& test : getRegisteredTests()) {
+            if (test.group[0] == '\0') {
+                testFunc(test.name, test.body, failed);
+            } else {
+                testFunc2(test.group, test.name, test.body, failed);
+            }
+        }
+    }
+
+#if UTEST_HAS_FORK_
+    // Isolated test currently running in a child process
+    struct IsolatedWorker {
+        std::size_t index;
+        pid_t pid;
+        int fd;
+        std::string output;
+        std::chrono::steady_clock::time_point start;
+    };
+    
+    // Child side: runs the test and sends "<passed> <unexpected> <elapsed>\n<error>" to the parent
+    inline void runIsolatedChild(PendingTest& test, int fd) {
+        TestResult result = test.result;
+        bool unexpected = false;
+        executeTestBody(test.body, result, unexpected);
         
-        // Get checkmark symbols
-        const char* successMark = getUseAsciiCheckmarks() ? "[OK]" : "✓";
-        const char* failMark = getUseAsciiCheckmarks() ? "[FAIL]" : "✗";
+        std::ostringstream ss;
+        ss << (result.passed ? 1 : 0) << ' ' << (unexpected ? 1 : 0) << ' '
+           << std::setprecision(17) << result.elapsedTime << '\n' << result.error;
+        const std::string data = ss.str();
+        std::size_t written = 0;
+        while (written < data.size()) {
+            const ssize_t count = ::write(fd, data.data() + written, data.size() - written);
+            if (count < 0 && errno == EINTR) {
+                continue;
+            }
+            if (count <= 0) {
+                break;
+            }
+            written += static_cast<std::size_t>(count);
+        }
+        std::cout.flush();
+        std::cerr.flush();
+        std::fflush(nullptr);
+        ::_exit(0);
+    }
+    
+    // Parent side: turns the worker's report, or the way it ended, into a test result.
+    // killReason is set when the parent killed the worker (timeout, poll failure).
+    inline TestResult finishIsolatedTest(const PendingTest& test, const IsolatedWorker& worker,
+                                         int status, const std::string& killReason, bool &failed) {
+        TestResult result = test.result;
+        const double wallTime = static_cast<double>(std::chrono::duration_cast<std::chrono::microseconds>(
+            std::chrono::steady_clock::now() - worker.start).count()) / 1000.0;
+        bool unexpected = false;
+        int passedFlag = 0;
+        int unexpectedFlag = 0;
+        double elapsed = 0.0;
+        std::istringstream in(worker.output);
         
-        // Show test name before execution if verbose mode is enabled
-        if (getVerboseMode()) {
-            std::cout << "Running test: " << std::string(group) << "::" << std::string(name) << "\n";
+        if (!killReason.empty()) {
+            result.passed = false;
+            result.error = killReason;
+            result.elapsedTime = wallTime;
+        } else if (WIFEXITED(status) && WEXITSTATUS(status) == 0 && (in >> passedFlag >> unexpectedFlag >> elapsed)) {
+            in.get();
+            result.passed = passedFlag != 0;
+            result.error.assign(std::istreambuf_iterator<char>(in), std::istreambuf_iterator<char>());
+            result.elapsedTime = elapsed;
+            unexpected = unexpectedFlag != 0;
+        } else {
+            std::ostringstream ss;
+            if (WIFSIGNALED(status)) {
+                ss << "crashed with signal " << WTERMSIG(status) << " (" << strsignal(WTERMSIG(status)) << ")";
+            } else {
+                ss << "worker process exited with code " << (WIFEXITED(status) ? WEXITSTATUS(status) : -1);
+            }
+            result.passed = false;
+            result.error = ss.str();
+            result.elapsedTime = wallTime;
         }
         
-        auto start = std::chrono::high_resolution_clock::now();
+        reportTestOutcome(result, unexpected);
+        if (!result.passed) {
+            failed = true;
+        }
+        return result;
+    }
+    
+    inline void waitForWorker(pid_t pid, int& status) {
+        while (::waitpid(pid, &status, 0) < 0 && errno == EINTR) {
+        }
+    }
+    
+    // Runs queued tests in forked workers, at most getParallelJobs() at a time,
+    // killing those exceeding getTestTimeoutMs(). Results keep the queue order.
+    // If the workers cannot be watched (poll() fails), the running ones are killed
+    // and reported as failed, and the remaining tests run in this process.
+    inline void runIsolatedTests(std::vector<PendingTest>& plan, bool &failed) {
+        std::size_t jobs = getParallelJobs();
+        if (jobs == 0) {
+            const long cpus = ::sysconf(_SC_NPROCESSORS_ONLN);
+            jobs = cpus > 0 ? static_cast<std::size_t>(cpus) : 1;
+        }
+        const long timeoutMs = getTestTimeoutMs();
         
-        try {
-            f();
-            auto end = std::chrono::high_resolution_clock::now();
-            auto duration = std::chrono::duration_cast<std::chrono::microseconds>(end - start);
-            result.elapsedTime = static_cast<double>(duration.count()) / 1000.0; // Convert to milliseconds
-            
-            std::cout << successMark << " Test [" << std::string(group) << "::" << std::string(name) << "] succeeded";
-            if (getShowPerformanceInfo()) {
-                std::cout << " (" << std::fixed << std::setprecision(3) << result.elapsedTime << "ms)";
+        std::vector<TestResult> results(plan.size());
+        std::vector<IsolatedWorker> workers;
+        std::size_t next = 0;
+        bool inProcess = false;
+        char buffer[4096];
+        
+        while (next < plan.size() || !workers.empty()) {
+            while (next < plan.size() && workers.size() < jobs) {
+                if (getVerboseMode()) {
+                    std::cout << "Running test: " << testDisplayName(plan[next].result) << "\n";
+                }
+                std::cout.flush();
+                std::cerr.flush();
+                std::fflush(nullptr);
+                
+                int fds[2];
+                pid_t pid = -1;
+                if (!inProcess && ::pipe(fds) == 0) {
+                    pid = ::fork();
+                    if (pid < 0) {
+                        ::close(fds[0]);
+                        ::close(fds[1]);
+                    }
+                }
+                if (pid == 0) {
+                    ::close(fds[0]);
+                    runIsolatedChild(plan[next], fds[1]);
+                }
+                if (pid < 0) {
+                    // Cannot isolate, run in this process instead
+                    TestResult result = plan[next].result;
+                    bool unexpected = false;
+                    executeTestBody(plan[next].body, result, unexpected);
+                    reportTestOutcome(result, unexpected);
+                    if (!result.passed) {
+                        failed = true;
+                    }
+                    results[next++] = result;
+                    continue;
+                }
+                ::close(fds[1]);
+                
+                IsolatedWorker worker;
+                worker.index = next++;
+                worker.pid = pid;
+                worker.fd = fds[0];
+                worker.start = std::chrono::steady_clock::now();
+                workers.push_back(worker);
+            }
+            if (workers.empty()) {
+                continue;
             }
-            std::cout << "\n";
-        }
-        catch (const AssertionException &e) {
-            auto end = std::chrono::high_resolution_clock::now();
-            auto duration = std::chrono::duration_cast<std::chrono::microseconds>(end - start);
-            result.elapsedTime = static_cast<double>(duration.count()) / 1000.0;
             
-            std::cout << failMark << " Test [" << std::string(group) << "::" << std::string(name) << "] failed!, error: " << e.getFormattedMessage();
-            if (getShowPerformanceInfo()) {
-                std::cout << " (" << std::fixed << std::setprecision(3) << result.elapsedTime << "ms)";
+            int waitMs = -1;
+            const auto now = std::chrono::steady_clock::now();
+            std::vector<pollfd> pollFds(workers.size());
+            for (std::size_t i = 0; i < workers.size(); ++i) {
+                pollFds[i].fd = workers[i].fd;
+                pollFds[i].events = POLLIN;
+                pollFds[i].revents = 0;
+                if (timeoutMs > 0) {
+                    const long long left = timeoutMs - std::chrono::duration_cast<std::chrono::milliseconds>(
+                        now - workers[i].start).count();
+                    const int leftMs = left > 0 ? static_cast<int>(left) : 0;
+                    waitMs = waitMs < 0 ? leftMs : std::min(waitMs, leftMs);
+                }
+            }
+            if (::poll(pollFds.data(), static_cast<nfds_t>(pollFds.size()), waitMs) < 0) {
+                const int error = errno;
+                if (error == EINTR) {
+                    continue;
+                }
+                const std::string reason = std::string("killed: cannot watch isolated workers (poll: ") +
+                                           std::strerror(error) + ")";
+                for (const auto& worker : workers) {
+                    int status = 0;
+                    ::kill(worker.pid, SIGKILL);
+                    ::close(worker.fd);
+                    waitForWorker(worker.pid, status);
+                    results[worker.index] = finishIsolatedTest(plan[worker.index], worker, status, reason, failed);
+                }
+                workers.clear();
+                inProcess = true;
+                continue;
             }
-            std::cout << "\n";
-            failed = true;
-            result.passed = false;
-            result.error = e.getFormattedMessage();
-        }
-        catch (std::exception &e) {
-            auto end = std::chrono::high_resolution_clock::now();
-            auto duration = std::chrono::duration_cast<std::chrono::microseconds>(end - start);
-            result.elapsedTime = static_cast<double>(duration.count()) / 1000.0;
             
-            std::cout << failMark << " Test [" << std::string(group) << "::" << std::string(name) << "] failed with unexpected exception!, error: " << e.what();
-            if (getShowPerformanceInfo()) {
-                std::cout << " (" << std::fixed << std::setprecision(3) << result.elapsedTime << "ms)";
+            for (std::size_t i = workers.size(); i-- > 0;) {
+                IsolatedWorker& worker = workers[i];
+                bool done = false;
+                std::string killReason;
+                if (pollFds[i].revents != 0) {
+                    const ssize_t count = ::read(worker.fd, buffer, sizeof(buffer));
+                    if (count > 0) {
+                        worker.output.append(buffer, static_cast<std::size_t>(count));
+                    } else if (count == 0 || errno != EINTR) {
+                        done = true;
+                    }
+                }
+                if (!done && timeoutMs > 0 &&
+                    std::chrono::steady_clock::now() - worker.start >= std::chrono::milliseconds(timeoutMs)) {
+                    std::ostringstream ss;
+                    ss << "timed out after " << timeoutMs << "ms";
+                    ::kill(worker.pid, SIGKILL);
+                    done = true;
+                    killReason = ss.str();
+                }
+                if (done) {
+                    int status = 0;
+                    ::close(worker.fd);
+                    waitForWorker(worker.pid, status);
+                    results[worker.index] = finishIsolatedTest(plan[worker.index], worker, status, killReason, failed);
+                    workers.erase(workers.begin() + static_cast<std::ptrdiff_t>(i));
+                }
             }
-            std::cout << "\n";
-            failed = true;
-            result.passed = false;
-            result.error = e.what();
         }
         
-        getTestResults().push_back(result);
+        for (const auto& result : results) {
+            getTestResults().push_back(result);
+        }
+    }
+#endif
+
+    // Runs the tests queued by isolation or --shuffle
+    inline void runPendingTests(bool &failed) {
+        std::vector<PendingTest> plan;
+        plan.swap(getPendingTests());
+        if (plan.empty()) {
+            return;
+        }
+        
+        const RunOptions& options = getRunOptions();
+        if (options.shuffle) {
+            std::mt19937 engine(static_cast<std::mt19937::result_type>(options.seed));
+            std::shuffle(plan.begin(), plan.end(), engine);
+            std::cout << "Shuffled " << plan.size() << " tests with seed " << options.seed << "\n";
+        }
+        
+#if UTEST_HAS_FORK_
+        if (getIsolationMode()) {
+            runIsolatedTests(plan, failed);
+            return;
+        }
+#endif
+        for (auto& test : plan) {
+            runTestNow(test.result, test.body, failed);
+        }
     }
 
     template<typename Func>
@@ -1243,17 +1978,29 @@ namespace details {
  * 
  * Must be called at the beginning of main() before any test execution.
  * Initializes error tracking and clears any previous test results.
+ * When given argc/argv, the following options are recognized:
+ * 
+ * - `--filter=Group::Name` - run matching tests only; comma-separated patterns,
+ *   `*` and `?` wildcards, a pattern without `::` selects a whole group
+ * - `--repeat=N` - run each selected test N times
+ * - `--shard=i/n` - run only the i-th (0-based) of n interleaved slices of the selected tests
+ * - `--shuffle[=seed]` - run tests in random order; the seed is printed for reproduction
+ * - `--verbose` - same as UTEST_ENABLE_VERBOSE_MODE()
+ * - `--isolate`, `--jobs=N`, `--timeout=MS` - see UTEST_ENABLE_ISOLATION()
+ * 
+ * With --filter or --shard an empty selection is not treated as a failure.
  * 
  * @code{.cpp}
- * int main() {
- *     UTEST_PROLOG();  // Always call first
+ * int main(int argc, char* argv[]) {
+ *     UTEST_PROLOG(argc, argv);  // Always call first
  *     // ... run tests ...
  *     UTEST_EPILOG();
  * }
  * @endcode
  */
-#define UTEST_PROLOG() bool errorFound = false; \
-    utest::details::getTestResults().clear()
+#define UTEST_PROLOG(...) bool errorFound = false; \
+    utest::details::getTestResults().clear(); \
+    utest::details::parseCommandLine(__VA_ARGS__)
 
 /**
  * @brief Allow tests to run even if no test functions are executed
@@ -1356,6 +2103,42 @@ namespace details {
  */
 #define UTEST_ENABLE_VERBOSE_MODE() utest::details::getVerboseMode() = true
 
+/**
+ * @brief Run each test in a forked worker process (POSIX only)
+ * 
+ * A test that crashes, aborts or hangs (see UTEST_SET_TEST_TIMEOUT_MS) is
+ * reported as failed and the remaining tests still run. Tests registered with
+ * UTEST_FUNC/UTEST_FUNC2 after this call are executed by UTEST_EPILOG().
+ * Ignored where fork() is not available or UTEST_NO_FORK is defined.
+ * 
+ * @code{.cpp}
+ * int main() {
+ *     UTEST_PROLOG();
+ *     UTEST_ENABLE_ISOLATION();
+ *     UTEST_FUNC2(Parser, DeeplyNested);  // a crash here does not stop the run
+ *     UTEST_EPILOG();
+ * }
+ * @endcode
+ */
+#define UTEST_ENABLE_ISOLATION() utest::details::getIsolationMode() = true
+
+/**
+ * @brief Set a wall-clock limit for isolated tests
+ * @param ms Limit in milliseconds, 0 disables it
+ * 
+ * Workers exceeding the limit are killed and the test fails with
+ * "timed out after <ms>ms". Applies only with UTEST_ENABLE_ISOLATION().
+ */
+#define UTEST_SET_TEST_TIMEOUT_MS(ms) utest::details::getTestTimeoutMs() = (ms)
+
+/**
+ * @brief Set how many isolated tests run at the same time
+ * @param n Number of worker processes, 0 for one per online CPU
+ * 
+ * Applies only with UTEST_ENABLE_ISOLATION(); the default is 1.
+ */
+#define UTEST_SET_PARALLEL_JOBS(n) utest::details::getParallelJobs() = (n)
+
 /** @} */ // end of test_execution group
 
 /**
@@ -1369,6 +2152,8 @@ namespace details {
  * @param a Test name
  * 
  * Creates a test function named test_##a() that can be executed with UTEST_FUNC(a).
+ * The test is also registered, so UTEST_RUN_REGISTERED() and UTEST_MAIN() run it
+ * without listing it in main().
  * 
  * @code{.cpp}
  * UTEST_FUNC_DEF(BasicArithmetic) {
@@ -1382,7 +2167,9 @@ namespace details {
  * }
  * @endcode
  */
-#define UTEST_FUNC_DEF(a) void test_##a()
+#define UTEST_FUNC_DEF(a) void test_##a(); \
+    static const utest::details::TestRegistrar utest_registrar_##a("", #a, &test_##a); \
+    void test_##a()
 
 /**
  * @brief Define a grouped test function
@@ -1391,6 +2178,7 @@ namespace details {
  * 
  * Creates a test function named test_##a##_##b() that can be executed with UTEST_FUNC2(a, b).
  * Tests with the same group name will be displayed together in the test summary.
+ * Like UTEST_FUNC_DEF, the test is registered for UTEST_RUN_REGISTERED().
  * 
  * @code{.cpp}
  * UTEST_FUNC_DEF2(Calculator, Addition) {
@@ -1409,7 +2197,9 @@ namespace details {
  * }
  * @endcode
  */
-#define UTEST_FUNC_DEF2(a, b) void test_##a##_##b()
+#define UTEST_FUNC_DEF2(a, b) void test_##a##_##b(); \
+    static const utest::details::TestRegistrar utest_registrar_##a##_##b(#a, #b, &test_##a##_##b); \
+    void test_##a##_##b()
 
 /** @} */ // end of test_definition group
 
@@ -1434,6 +2224,44 @@ namespace details {
  */
 #define UTEST_FUNC2(a, b) utest::details::testFunc2(#a, #b, test_##a##_##b, errorFound)
 
+/**
+ * @brief Execute every test defined in this binary
+ * 
+ * Runs the tests defined with UTEST_FUNC_DEF/UTEST_FUNC_DEF2 in definition
+ * order (per translation unit), honouring --filter, --shard and --repeat.
+ * Do not combine with UTEST_FUNC/UTEST_FUNC2 calls for the same tests.
+ * 
+ * @code{.cpp}
+ * int main(int argc, char* argv[]) {
+ *     UTEST_PROLOG(argc, argv);
+ *     UTEST_RUN_REGISTERED();
+ *     UTEST_EPILOG();
+ * }
+ * @endcode
+ */
+#define UTEST_RUN_REGISTERED() utest::details::runRegisteredTests(errorFound)
+
+/**
+ * @brief Define main() running all registered tests
+ * 
+ * Shorthand for a main() made of UTEST_PROLOG(argc, argv), UTEST_RUN_REGISTERED()
+ * and UTEST_EPILOG(), so each test binary is its own driver.
+ * 
+ * @code{.cpp}
+ * UTEST_FUNC_DEF2(Calculator, Addition) {
+ *     UTEST_ASSERT_EQUALS(2 + 3, 5);
+ * }
+ * 
+ * UTEST_MAIN()
+ * @endcode
+ */
+#define UTEST_MAIN() \
+int main(int argc, char* argv[]) { \
+    UTEST_PROLOG(argc, argv); \
+    UTEST_RUN_REGISTERED(); \
+    UTEST_EPILOG(); \
+}
+
 /**
  * @brief Finalize testing and display results
  * 
@@ -1441,6 +2269,8 @@ namespace details {
  * appropriate exit code. Returns EXIT_SUCCESS if all tests passed,
  * EXIT_FAILURE if any test failed or no tests were run (unless allowed).
  * 
+ * Tests queued by UTEST_ENABLE_ISOLATION() are executed first.
+ * 
  * The summary includes:
  * - Individual test results with checkmarks
  * - Grouped display for UTEST_FUNC2 tests
@@ -1457,6 +2287,7 @@ namespace details {
  * @endcode
  */
 #define UTEST_EPILOG() do { \
+    utest::details::runPendingTests(errorFound); \
     std::cout << "\n======================================\n"; \
     std::cout << "Test Summary:\n"; \
     std::cout << "======================================\n"; \
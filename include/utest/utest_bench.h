@@ -0,0 +1,709 @@
+#ifndef __UTEST_BENCH_H__
+#define __UTEST_BENCH_H__
+
+/**
+ * @file utest_bench.h
+ * @brief Micro-benchmark runner with baseline comparison for utest
+ *
+ * Benchmarks are defined like tests and registered automatically. Each body
+ * performs one operation; the runner calibrates an iteration count, takes
+ * several timed samples and reports the median time per operation together
+ * with the number of heap allocations per operation.
+ *
+ * @code{.cpp}
+ * #include "utest/utest_bench.h"
+ *
+ * UTEST_BENCH_COUNT_ALLOCATIONS()   // once per binary: count operator new calls
+ *
+ * UTEST_BENCH_DEF2(ToString, Int) {
+ *     utest::bench::doNotOptimize(ustr::to_string(42));
+ * }
+ *
+ * UTEST_BENCH_MAIN()
+ * @endcode
+ *
+ * Command line options:
+ * - `--filter=Group::Name` - run matching benchmarks (same patterns as tests)
+ * - `--samples=N` - timed samples per benchmark (default 15)
+ * - `--sample-ms=MS` - target duration of one sample (default 5)
+ * - `--json=PATH` - write results as JSON, e.g. to refresh a baseline
+ * - `--baseline=PATH` - compare with a JSON baseline and print a delta table
+ * - `--tolerance=F` - allowed relative slowdown of the median (default 0.25)
+ * - `--alloc-tolerance=F` - allowed extra allocations per operation (default 0)
+ * - `--retries=N` - re-measurements of a benchmark that looks slower (default 2)
+ * - `--perf` - also report hardware counters per operation (Linux perf_event_open):
+ *   instructions, cycles, branch misses and cache misses
+ *
+ * Counters are read in user space only. When perf_event_open is not available
+ * (other platforms, containers without perf permissions, perf_event_paranoid
+ * above 2, VMs without a PMU) a note is printed and only times are reported;
+ * individual counters the CPU does not provide are left out.
+ * With --baseline the binary exits with failure when a benchmark is slower
+ * or allocates more than allowed. A baseline entry may carry its own
+ * "tolerance" value overriding --tolerance.
+ */
+
+#include "utest.h"
+
+#include <atomic>
+#include <cstdio>
+#include <fstream>
+#include <memory>
+#include <new>
+
+#if defined(__linux__) && !defined(UTEST_BENCH_NO_PERF)
+#define UTEST_BENCH_HAS_PERF_ 1
+#include <cerrno>
+#include <linux/perf_event.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#else
+#define UTEST_BENCH_HAS_PERF_ 0
+#endif
+
+namespace utest {
+namespace bench {
+
+/**
+ * @brief Heap allocations seen so far (counted only with UTEST_BENCH_COUNT_ALLOCATIONS)
+ */
+inline std::atomic<unsigned long long>& allocationCount() {
+    static std::atomic<unsigned long long> count(0);
+    return count;
+}
+
+inline bool& allocationCountingEnabled() {
+    static bool enabled = false;
+    return enabled;
+}
+
+inline double& bytesPerOperation() {
+    static double bytes = 0.0;
+    return bytes;
+}
+
+/**
+ * @brief Report how many bytes one operation of the running benchmark processes
+ *
+ * Call it from the benchmark body; the output then includes throughput in MB/s.
+ */
+inline void setBytesPerOp(std::size_t bytes) {
+    bytesPerOperation() = static_cast<double>(bytes);
+}
+
+/**
+ * @brief Keep a computed value alive so the optimizer cannot drop the work producing it
+ */
+template<typename T>
+inline void doNotOptimize(const T& value) {
+#if defined(__GNUC__) || defined(__clang__)
+    asm volatile("" : : "r,m"(value) : "memory");
+#else
+    static volatile const void* sink;
+    sink = &value;
+#endif
+}
+
+/**
+ * @brief Measurement of one benchmark
+ */
+struct Result {
+    std::string name;       ///< "Group::Name"
+    double medianNs;        ///< Median time per operation in nanoseconds
+    double minNs;           ///< Fastest sample per operation in nanoseconds
+    double allocsPerOp;     ///< Heap allocations per operation, -1 when not counted
+    unsigned long long iterations;  ///< Operations per sample
+    double instructionsPerOp;   ///< Retired instructions per operation, -1 when not counted
+    double cyclesPerOp;         ///< CPU cycles per operation, -1 when not counted
+    double branchMissesPerOp;   ///< Mispredicted branches per operation, -1 when not counted
+    double cacheMissesPerOp;    ///< Last-level cache misses per operation, -1 when not counted
+    double bytesPerOp;          ///< Bytes processed per operation (setBytesPerOp), -1 when not set
+};
+
+/**
+ * @brief Baseline entry read from JSON
+ */
+struct BaselineEntry {
+    double medianNs;
+    double allocsPerOp;
+    double tolerance;       ///< Per-benchmark override of --tolerance, -1 when absent
+};
+
+namespace details {
+
+    struct RegisteredBenchmark {
+        const char* group;
+        const char* name;
+        void (*body)();
+    };
+
+    inline std::vector<RegisteredBenchmark>& getRegisteredBenchmarks() {
+        static std::vector<RegisteredBenchmark> registered;
+        return registered;
+    }
+
+    // Static object created next to each benchmark definition to register it
+    struct BenchmarkRegistrar {
+        BenchmarkRegistrar(const char* group, const char* name, void (*body)()) {
+            RegisteredBenchmark benchmark = {group, name, body};
+            getRegisteredBenchmarks().push_back(benchmark);
+        }
+    };
+
+    struct BenchOptions {
+        std::vector<std::string> filters;
+        unsigned long samples;
+        double sampleMs;
+        std::string jsonPath;
+        std::string baselinePath;
+        double tolerance;
+        double allocTolerance;
+        unsigned long retries;
+        bool perf;
+
+        BenchOptions() : samples(15), sampleMs(5.0), tolerance(0.25), allocTolerance(0.0), retries(2), perf(false) {}
+    };
+
+    // Hardware counters of the calling thread, opened as one perf_event group
+    // so they are scheduled together. Counters that cannot be opened stay -1.
+    class PerfCounters {
+    public:
+        enum Counter { Instructions, Cycles, BranchMisses, CacheMisses, CounterCount };
+
+        PerfCounters() : leader_(-1), opened_(0) {
+            for (int i = 0; i < CounterCount; ++i) {
+                fds_[i] = -1;
+                slots_[i] = -1;
+            }
+#if UTEST_BENCH_HAS_PERF_
+            static const unsigned long long configs[CounterCount] = {
+                PERF_COUNT_HW_INSTRUCTIONS, PERF_COUNT_HW_CPU_CYCLES,
+                PERF_COUNT_HW_BRANCH_MISSES, PERF_COUNT_HW_CACHE_MISSES
+            };
+            for (int i = 0; i < CounterCount; ++i) {
+                perf_event_attr attr;
+                std::memset(&attr, 0, sizeof(attr));
+                attr.type = PERF_TYPE_HARDWARE;
+                attr.size = sizeof(attr);
+                attr.config = configs[i];
+                if (leader_ < 0) {
+                    attr.disabled = 1;  // members follow the leader
+                }
+                attr.exclude_kernel = 1;
+                attr.exclude_hv = 1;
+                attr.read_format = PERF_FORMAT_GROUP | PERF_FORMAT_TOTAL_TIME_ENABLED | PERF_FORMAT_TOTAL_TIME_RUNNING;
+                const long fd = syscall(__NR_perf_event_open, &attr, 0, -1, leader_, 0);
+                if (fd < 0) {
+                    if (error_.empty()) {
+                        error_ = std::strerror(errno);
+                    }
+                    continue;
+                }
+                fds_[i] = static_cast<int>(fd);
+                slots_[i] = opened_++;
+                if (leader_ < 0) {
+                    leader_ = fds_[i];
+                }
+            }
+#else
+            error_ = "not supported on this platform";
+#endif
+        }
+
+        ~PerfCounters() {
+#if UTEST_BENCH_HAS_PERF_
+            for (int i = 0; i < CounterCount; ++i) {
+                if (fds_[i] >= 0) {
+                    close(fds_[i]);
+                }
+            }
+#endif
+        }
+
+        bool available() const { return leader_ >= 0; }
+
+        // Reason the first counter failed to open
+        const std::string& error() const { return error_; }
+
+        void start() {
+#if UTEST_BENCH_HAS_PERF_
+            ioctl(leader_, PERF_EVENT_IOC_RESET, PERF_IOC_FLAG_GROUP);
+            ioctl(leader_, PERF_EVENT_IOC_ENABLE, PERF_IOC_FLAG_GROUP);
+#endif
+        }
+
+        // Stops counting and stores the counts, scaled up when the kernel multiplexed them
+        void stop(double (&counts)[CounterCount]) {
+            for (int i = 0; i < CounterCount; ++i) {
+                counts[i] = -1.0;
+            }
+#if UTEST_BENCH_HAS_PERF_
+            ioctl(leader_, PERF_EVENT_IOC_DISABLE, PERF_IOC_FLAG_GROUP);
+            unsigned long long data[3 + CounterCount];
+            const ssize_t size = read(leader_, data, sizeof(data));
+            if (size < static_cast<ssize_t>(3 * sizeof(data[0])) || data[2] == 0) {
+                return;
+            }
+            const double scale = static_cast<double>(data[1]) / static_cast<double>(data[2]);
+            for (int i = 0; i < CounterCount; ++i) {
+                if (slots_[i] >= 0 && static_cast<unsigned long long>(slots_[i]) < data[0]) {
+                    counts[i] = static_cast<double>(data[3 + slots_[i]]) * scale;
+                }
+            }
+#endif
+        }
+
+    private:
+        PerfCounters(const PerfCounters&);
+        PerfCounters& operator=(const PerfCounters&);
+
+        int fds_[CounterCount];
+        int slots_[CounterCount];   // position of each counter in the group read
+        int leader_;
+        int opened_;
+        std::string error_;
+    };
+
+    inline bool parseDouble(const std::string& text, double& value) {
+        if (text.empty()) {
+            return false;
+        }
+        char* end = nullptr;
+        value = std::strtod(text.c_str(), &end);
+        return *end == '\0' && value >= 0.0;
+    }
+
+    inline bool parseBenchOptions(int argc, const char* const* argv, BenchOptions& options) {
+        bool valid = true;
+        for (int i = 1; i < argc; ++i) {
+            const std::string arg = argv[i];
+            std::string value;
+            unsigned long number = 0;
+            bool ok = true;
+
+            if (utest::details::hasPrefix(arg, "--filter=", value)) {
+                std::istringstream patterns(value);
+                std::string pattern;
+                while (std::getline(patterns, pattern, ',')) {
+                    if (!pattern.empty()) {
+                        options.filters.push_back(pattern);
+                    }
+                }
+            } else if (utest::details::hasPrefix(arg, "--samples=", value)) {
+                ok = utest::details::parseUnsigned(value, number) && number > 0;
+                if (ok) {
+                    options.samples = number;
+                }
+            } else if (utest::details::hasPrefix(arg, "--sample-ms=", value)) {
+                ok = parseDouble(value, options.sampleMs) && options.sampleMs > 0.0;
+            } else if (utest::details::hasPrefix(arg, "--json=", value)) {
+                options.jsonPath = value;
+            } else if (utest::details::hasPrefix(arg, "--baseline=", value)) {
+                options.baselinePath = value;
+            } else if (utest::details::hasPrefix(arg, "--tolerance=", value)) {
+                ok = parseDouble(value, options.tolerance);
+            } else if (utest::details::hasPrefix(arg, "--alloc-tolerance=", value)) {
+                ok = parseDouble(value, options.allocTolerance);
+            } else if (utest::details::hasPrefix(arg, "--retries=", value)) {
+                ok = utest::details::parseUnsigned(value, options.retries);
+            } else if (arg == "--perf") {
+                options.perf = true;
+            } else {
+                ok = false;
+            }
+
+            if (!ok) {
+                std::cerr << "utest: invalid benchmark option '" << arg << "'\n";
+                valid = false;
+            }
+        }
+        return valid;
+    }
+
+    inline bool isBenchmarkSelected(const BenchOptions& options, const RegisteredBenchmark& benchmark) {
+        if (options.filters.empty()) {
+            return true;
+        }
+        const std::string name = std::string(benchmark.group) + "::" + benchmark.name;
+        for (const auto& pattern : options.filters) {
+            if (utest::details::wildcardMatch(pattern.c_str(), name.c_str()) ||
+                (pattern.find("::") == std::string::npos &&
+                 utest::details::wildcardMatch(pattern.c_str(), benchmark.group))) {
+                return true;
+            }
+        }
+        return false;
+    }
+
+    // Runs the body n times, returning elapsed nanoseconds
+    inline double timeIterations(void (*body)(), unsigned long long n) {
+        auto start = std::chrono::steady_clock::now();
+        for (unsigned long long i = 0; i < n; ++i) {
+            body();
+        }
+        auto end = std::chrono::steady_clock::now();
+        return static_cast<double>(std::chrono::duration_cast<std::chrono::nanoseconds>(end - start).count());
+    }
+
+    inline Result runBenchmark(const RegisteredBenchmark& benchmark, const BenchOptions& options,
+                               PerfCounters* counters) {
+        Result result;
+        result.name = std::string(benchmark.group) + "::" + benchmark.name;
+
+        bytesPerOperation() = 0.0;
+        // Calibrate (and warm up) until one sample lasts about sampleMs
+        const double targetNs = options.sampleMs * 1e6;
+        unsigned long long iterations = 1;
+        double elapsed = timeIterations(benchmark.body, iterations);
+        while (elapsed < targetNs && iterations < (1ull << 40)) {
+            const double scale = elapsed > 0.0 ? targetNs / elapsed : 10.0;
+            iterations = static_cast<unsigned long long>(static_cast<double>(iterations) * std::min(10.0, std::max(1.5, scale * 1.1)));
+            elapsed = timeIterations(benchmark.body, iterations);
+        }
+
+        std::vector<double> perOp;
+        perOp.reserve(options.samples);
+        const unsigned long long allocsBefore = allocationCount().load(std::memory_order_relaxed);
+        if (counters) {
+            counters->start();
+        }
+        for (unsigned long i = 0; i < options.samples; ++i) {
+            perOp.push_back(timeIterations(benchmark.body, iterations) / static_cast<double>(iterations));
+        }
+        double counts[PerfCounters::CounterCount];
+        if (counters) {
+            counters->stop(counts);
+        } else {
+            std::fill(counts, counts + PerfCounters::CounterCount, -1.0);
+        }
+        const unsigned long long allocs = allocationCount().load(std::memory_order_relaxed) - allocsBefore;
+        const double operations = static_cast<double>(iterations) * static_cast<double>(options.samples);
+
+        std::sort(perOp.begin(), perOp.end());
+        const std::size_t middle = perOp.size() / 2;
+        result.medianNs = perOp.size() % 2 ? perOp[middle] : (perOp[middle - 1] + perOp[middle]) / 2.0;
+        result.minNs = perOp.front();
+        result.iterations = iterations;
+        result.allocsPerOp = allocationCountingEnabled() ? static_cast<double>(allocs) / operations : -1.0;
+        result.instructionsPerOp = counts[PerfCounters::Instructions] >= 0.0 ? counts[PerfCounters::Instructions] / operations : -1.0;
+        result.cyclesPerOp = counts[PerfCounters::Cycles] >= 0.0 ? counts[PerfCounters::Cycles] / operations : -1.0;
+        result.branchMissesPerOp = counts[PerfCounters::BranchMisses] >= 0.0 ? counts[PerfCounters::BranchMisses] / operations : -1.0;
+        result.cacheMissesPerOp = counts[PerfCounters::CacheMisses] >= 0.0 ? counts[PerfCounters::CacheMisses] / operations : -1.0;
+        result.bytesPerOp = bytesPerOperation() > 0.0 ? bytesPerOperation() : -1.0;
+        return result;
+    }
+
+    inline std::string formatNumber(double value, int precision) {
+        std::ostringstream ss;
+        ss << std::fixed << std::setprecision(precision) << value;
+        return ss.str();
+    }
+
+    inline std::string escapeJson(const std::string& text) {
+        std::string out;
+        for (char c : text) {
+            if (c == '"' || c == '\\') {
+                out += '\\';
+            }
+            out += c;
+        }
+        return out;
+    }
+
+    inline bool writeJson(const std::string& path, const std::vector<Result>& results) {
+        std::ofstream out(path.c_str());
+        if (!out) {
+            return false;
+        }
+        out << "{\n  \"benchmarks\": [\n";
+        for (std::size_t i = 0; i < results.size(); ++i) {
+            const Result& r = results[i];
+            out << "    {\"name\": \"" << escapeJson(r.name) << "\", "
+                << "\"median_ns\": " << formatNumber(r.medianNs, 3) << ", "
+                << "\"allocs_per_op\": " << formatNumber(r.allocsPerOp, 3);
+            const struct { const char* key; double value; } counters[] = {
+                {"instructions_per_op", r.instructionsPerOp}, {"cycles_per_op", r.cyclesPerOp},
+                {"branch_misses_per_op", r.branchMissesPerOp}, {"cache_misses_per_op", r.cacheMissesPerOp},
+                {"bytes_per_op", r.bytesPerOp}
+            };
+            for (const auto& counter : counters) {
+                if (counter.value >= 0.0) {
+                    out << ", \"" << counter.key << "\": " << formatNumber(counter.value, 3);
+                }
+            }
+            out << "}" << (i + 1 < results.size() ? "," : "") << "\n";
+        }
+        out << "  ]\n}\n";
+        return static_cast<bool>(out);
+    }
+
+    // Minimal reader for the flat format written by writeJson
+    class BaselineReader {
+        const std::string& text_;
+        std::size_t pos_;
+
+        void skipSpace() {
+            while (pos_ < text_.size() && std::strchr(" \t\r\n,:", text_[pos_])) {
+                ++pos_;
+            }
+        }
+
+        bool readString(std::string& value) {
+            skipSpace();
+            if (pos_ >= text_.size() || text_[pos_] != '"') {
+                return false;
+            }
+            value.clear();
+            for (++pos_; pos_ < text_.size() && text_[pos_] != '"'; ++pos_) {
+                if (text_[pos_] == '\\' && pos_ + 1 < text_.size()) {
+                    ++pos_;
+                }
+                value += text_[pos_];
+            }
+            ++pos_;
+            return pos_ <= text_.size();
+        }
+
+        bool readNumber(double& value) {
+            skipSpace();
+            const char* start = text_.c_str() + pos_;
+            char* end = nullptr;
+            value = std::strtod(start, &end);
+            pos_ += static_cast<std::size_t>(end - start);
+            return end != start;
+        }
+
+    public:
+        explicit BaselineReader(const std::string& text) : text_(text), pos_(0) {}
+
+        bool read(std::map<std::string, BaselineEntry>& entries) {
+            pos_ = text_.find("\"benchmarks\"");
+            if (pos_ == std::string::npos || (pos_ = text_.find('[', pos_)) == std::string::npos) {
+                return false;
+            }
+            ++pos_;
+            for (skipSpace(); pos_ < text_.size() && text_[pos_] == '{'; skipSpace()) {
+                ++pos_;
+                std::string name;
+                BaselineEntry entry = {0.0, -1.0, -1.0};
+                for (skipSpace(); pos_ < text_.size() && text_[pos_] != '}'; skipSpace()) {
+                    std::string key;
+                    if (!readString(key)) {
+                        return false;
+                    }
+                    bool ok = true;
+                    if (key == "name") {
+                        ok = readString(name);
+                    } else if (key == "median_ns") {
+                        ok = readNumber(entry.medianNs);
+                    } else if (key == "allocs_per_op") {
+                        ok = readNumber(entry.allocsPerOp);
+                    } else if (key == "tolerance") {
+                        ok = readNumber(entry.tolerance);
+                    } else {
+                        std::string ignored;
+                        double ignoredNumber = 0.0;
+                        ok = readString(ignored) || readNumber(ignoredNumber);
+                    }
+                    if (!ok) {
+                        return false;
+                    }
+                }
+                ++pos_;
+                entries[name] = entry;
+            }
+            return true;
+        }
+    };
+
+    inline bool readBaseline(const std::string& path, std::map<std::string, BaselineEntry>& entries) {
+        std::ifstream in(path.c_str());
+        if (!in) {
+            return false;
+        }
+        const std::string text((std::istreambuf_iterator<char>(in)), std::istreambuf_iterator<char>());
+        return BaselineReader(text).read(entries);
+    }
+
+    inline std::string padRight(const std::string& text, std::size_t width) {
+        return text.size() >= width ? text + " " : text + std::string(width - text.size(), ' ');
+    }
+
+    // Prints the delta table; returns false when any benchmark regressed
+    inline bool compareWithBaseline(const std::vector<Result>& results,
+                                    const std::map<std::string, BaselineEntry>& baseline,
+                                    const BenchOptions& options) {
+        bool passed = true;
+        std::cout << "\n" << padRight("Benchmark", 36) << padRight("Base ns", 12) << padRight("Now ns", 12)
+                  << padRight("Delta", 10) << padRight("Allocs base/now", 18) << "Status\n";
+        for (const auto& r : results) {
+            auto it = baseline.find(r.name);
+            std::cout << padRight(r.name, 36);
+            if (it == baseline.end()) {
+                std::cout << padRight("-", 12) << padRight(formatNumber(r.medianNs, 1), 12)
+                          << padRight("-", 10) << padRight("-/" + formatNumber(r.allocsPerOp, 2), 18) << "new\n";
+                continue;
+            }
+            const BaselineEntry& base = it->second;
+            const double tolerance = base.tolerance >= 0.0 ? base.tolerance : options.tolerance;
+            const double delta = base.medianNs > 0.0 ? r.medianNs / base.medianNs - 1.0 : 0.0;
+            const bool slower = delta > tolerance;
+            const bool moreAllocs = base.allocsPerOp >= 0.0 && r.allocsPerOp >= 0.0 &&
+                                    r.allocsPerOp > base.allocsPerOp + options.allocTolerance + 1e-9;
+            std::cout << padRight(formatNumber(base.medianNs, 1), 12) << padRight(formatNumber(r.medianNs, 1), 12)
+                      << padRight((delta >= 0.0 ? "+" : "") + formatNumber(delta * 100.0, 1) + "%", 10)
+                      << padRight(formatNumber(base.allocsPerOp, 2) + "/" + formatNumber(r.allocsPerOp, 2), 18)
+                      << (slower ? "SLOWER" : (moreAllocs ? "ALLOCS" : "ok")) << "\n";
+            if (slower || moreAllocs) {
+                passed = false;
+            }
+        }
+        return passed;
+    }
+
+    // True when the result is slower than the baseline allows
+    inline bool isSlower(const Result& result, const std::map<std::string, BaselineEntry>& baseline,
+                         const BenchOptions& options) {
+        auto it = baseline.find(result.name);
+        if (it == baseline.end() || it->second.medianNs <= 0.0) {
+            return false;
+        }
+        const double tolerance = it->second.tolerance >= 0.0 ? it->second.tolerance : options.tolerance;
+        return result.medianNs > it->second.medianNs * (1.0 + tolerance);
+    }
+
+    inline int runMain(int argc, const char* const* argv) {
+        BenchOptions options;
+        if (!parseBenchOptions(argc, argv, options)) {
+            return EXIT_FAILURE;
+        }
+
+        std::map<std::string, BaselineEntry> baseline;
+        if (!options.baselinePath.empty() && !readBaseline(options.baselinePath, baseline)) {
+            std::cerr << "utest: cannot read baseline " << options.baselinePath << "\n";
+            return EXIT_FAILURE;
+        }
+
+        std::unique_ptr<PerfCounters> counters;
+        if (options.perf) {
+            counters.reset(new PerfCounters());
+            if (!counters->available()) {
+                std::cout << "utest: hardware counters unavailable (perf_event_open: " << counters->error()
+                          << "), reporting times only\n";
+                counters.reset();
+            }
+        }
+
+        std::vector<Result> results;
+        for (const auto& benchmark : getRegisteredBenchmarks()) {
+            if (!isBenchmarkSelected(options, benchmark)) {
+                continue;
+            }
+            Result r = runBenchmark(benchmark, options, counters.get());
+            // Re-measure apparent slowdowns to filter out noise from other processes
+            for (unsigned long retry = 0; retry < options.retries && isSlower(r, baseline, options); ++retry) {
+                const Result again = runBenchmark(benchmark, options, counters.get());
+                if (again.medianNs < r.medianNs) {
+                    r = again;
+                }
+            }
+            std::vector<std::string> columns;
+            columns.push_back(padRight(r.name, 36) + padRight(formatNumber(r.medianNs, 1) + " ns/op", 16) +
+                              "min " + formatNumber(r.minNs, 1) + " ns");
+            if (r.allocsPerOp >= 0.0) {
+                columns.push_back(formatNumber(r.allocsPerOp, 2) + " allocs/op");
+            }
+            if (r.bytesPerOp >= 0.0 && r.medianNs > 0.0) {
+                // bytes per ns is GB/s
+                columns.push_back(formatNumber(r.bytesPerOp / r.medianNs * 1000.0, 1) + " MB/s");
+            }
+            if (r.instructionsPerOp >= 0.0) {
+                columns.push_back(formatNumber(r.instructionsPerOp, 1) + " instr/op");
+            }
+            if (r.cyclesPerOp >= 0.0) {
+                columns.push_back(formatNumber(r.cyclesPerOp, 1) + " cycles/op");
+            }
+            if (r.branchMissesPerOp >= 0.0) {
+                columns.push_back(formatNumber(r.branchMissesPerOp, 3) + " br-miss/op");
+            }
+            if (r.cacheMissesPerOp >= 0.0) {
+                columns.push_back(formatNumber(r.cacheMissesPerOp, 3) + " cache-miss/op");
+            }
+            for (std::size_t c = 0; c < columns.size(); ++c) {
+                std::cout << (c + 1 < columns.size() ? padRight(columns[c], c == 0 ? 70 : 17) : columns[c]);
+            }
+            std::cout << "\n";
+            std::cout.flush();
+            results.push_back(r);
+        }
+
+        if (!options.jsonPath.empty() && !writeJson(options.jsonPath, results)) {
+            std::cerr << "utest: cannot write " << options.jsonPath << "\n";
+            return EXIT_FAILURE;
+        }
+        if (!options.baselinePath.empty()) {
+            if (!compareWithBaseline(results, baseline, options)) {
+                std::cout << "FAILURE (performance regression)\n";
+                return EXIT_FAILURE;
+            }
+            std::cout << "SUCCESS\n";
+        }
+        return EXIT_SUCCESS;
+    }
+
+} // namespace details
+
+} // namespace bench
+} // namespace utest
+
+/**
+ * @brief Define a benchmark measuring one operation per call
+ * @param a Group name
+ * @param b Benchmark name within the group
+ *
+ * Pass results to utest::bench::doNotOptimize() so the work is not optimized away.
+ */
+#define UTEST_BENCH_DEF2(a, b) void bench_##a##_##b(); \
+    static const utest::bench::details::BenchmarkRegistrar utest_bench_registrar_##a##_##b(#a, #b, &bench_##a##_##b); \
+    void bench_##a##_##b()
+
+/**
+ * @brief Define main() running all registered benchmarks
+ */
+#define UTEST_BENCH_MAIN() \
+int main(int argc, char* argv[]) { \
+    return utest::bench::details::runMain(argc, argv); \
+}
+
+#if defined(__cpp_sized_deallocation)
+#define UTEST_BENCH_SIZED_DELETE_ \
+UTEST_NOINLINE_ void operator delete(void* p, std::size_t) noexcept { \
+    std::free(p); \
+}
+#else
+#define UTEST_BENCH_SIZED_DELETE_
+#endif
+
+/**
+ * @brief Replace global operator new/delete to count allocations per operation
+ *
+ * Use once per benchmark binary, at namespace scope in one source file.
+ * The replacements are not inlined: GCC otherwise pairs the inlined malloc and
+ * free calls with new/delete expressions and reports -Wmismatched-new-delete.
+ */
+#define UTEST_BENCH_COUNT_ALLOCATIONS() \
+UTEST_NOINLINE_ void* operator new(std::size_t size) { \
+    utest::bench::allocationCount().fetch_add(1, std::memory_order_relaxed); \
+    if (void* p = std::malloc(size ? size : 1)) { \
+        return p; \
+    } \
+    throw std::bad_alloc(); \
+} \
+UTEST_NOINLINE_ void operator delete(void* p) noexcept { \
+    std::free(p); \
+} \
+UTEST_BENCH_SIZED_DELETE_ \
+static const bool utest_bench_allocation_counting_ = (utest::bench::allocationCountingEnabled() = true);
+
+#endif // __UTEST_BENCH_H__
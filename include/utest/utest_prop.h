@@ -0,0 +1,522 @@
+#ifndef __UTEST_PROP_H__
+#define __UTEST_PROP_H__
+
+/**
+ * @file utest_prop.h
+ * @brief Property-based testing for utest
+ *
+ * A property is checked against many generated values. Values come from
+ * utest::prop::Arbitrary<T>, which covers integers, doubles, strings (with
+ * delimiters, escape characters, control characters, UTF-8, BOMs and stray
+ * bytes), vectors, maps, pairs and tuples, nested in any combination. The
+ * property body uses ordinary UTEST_ASSERT_* macros; the first failing value
+ * is shrunk to a smaller counterexample and reported together with the seed.
+ *
+ * @code{.cpp}
+ * #include "utest/utest_prop.h"
+ *
+ * UTEST_FUNC_DEF2(QuotedStr, RoundTrip) {
+ *     utest::prop::forAll<std::string>("quoted_str round-trip", [](const std::string& s) {
+ *         std::string text;
+ *         UTEST_ASSERT_TRUE(ustr::unquoted_str(ustr::quoted_str(s), text));
+ *         UTEST_ASSERT_STR_EQUALS(text, s);
+ *     });
+ * }
+ * @endcode
+ *
+ * In verbose mode every property prints its throughput:
+ * `Property quoted_str round-trip: 2000 cases in 3.1 ms (645161 cases/sec)`.
+ *
+ * Environment variables:
+ * - `UTEST_PROP_CASES=N` - number of cases per property (overrides the default)
+ * - `UTEST_PROP_SEED=S` - seed for all properties, e.g. to replay a failure
+ *
+ * Without UTEST_PROP_SEED each property uses a fixed seed derived from its
+ * name, so runs are reproducible.
+ */
+
+#include "utest.h"
+
+#include <cstdint>
+#include <limits>
+#include <map>
+#include <tuple>
+#include <utility>
+
+namespace utest {
+namespace prop {
+
+/**
+ * @brief Fast pseudo-random generator (splitmix64) used by generators
+ */
+class Random {
+public:
+    explicit Random(std::uint64_t seed) : state_(seed) {}
+
+    std::uint64_t next() {
+        std::uint64_t z = (state_ += 0x9E3779B97F4A7C15ULL);
+        z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+        z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+        return z ^ (z >> 31);
+    }
+
+    /// Uniform value in [0, n), n must be positive
+    std::size_t below(std::size_t n) {
+        return static_cast<std::size_t>(next() % n);
+    }
+
+    /// True with probability 1/n
+    bool oneIn(std::size_t n) {
+        return below(n) == 0;
+    }
+
+private:
+    std::uint64_t state_;
+};
+
+/**
+ * @brief Generator and shrinker for values of type T
+ *
+ * Specializations provide:
+ * - `static T generate(Random& rng, std::size_t size)` - size grows from 1 during a run
+ *   and bounds string lengths, element counts and nesting
+ * - `static std::vector<T> shrink(const T& value)` - smaller candidates, simplest first
+ */
+template<typename T, typename Enable = void>
+struct Arbitrary;
+
+namespace details {
+
+    // Characters with a meaning in quoted strings, containers or logfmt/CSV output
+    inline const char* specialCharacters() {
+        return "\"\\[]{}()<>,:;=/'| ";
+    }
+
+    inline void appendUtf8(std::string& out, std::uint32_t code_point) {
+        if (code_point < 0x80) {
+            out += static_cast<char>(code_point);
+        } else if (code_point < 0x800) {
+            out += static_cast<char>(0xC0 | (code_point >> 6));
+            out += static_cast<char>(0x80 | (code_point & 0x3F));
+        } else if (code_point < 0x10000) {
+            out += static_cast<char>(0xE0 | (code_point >> 12));
+            out += static_cast<char>(0x80 | ((code_point >> 6) & 0x3F));
+            out += static_cast<char>(0x80 | (code_point & 0x3F));
+        } else {
+            out += static_cast<char>(0xF0 | (code_point >> 18));
+            out += static_cast<char>(0x80 | ((code_point >> 12) & 0x3F));
+            out += static_cast<char>(0x80 | ((code_point >> 6) & 0x3F));
+            out += static_cast<char>(0x80 | (code_point & 0x3F));
+        }
+    }
+
+    inline void appendRandomCodePoint(std::string& out, Random& rng) {
+        static const std::uint32_t limits[] = {0x800, 0x10000, 0x110000};
+        const std::uint32_t limit = limits[rng.below(3)];
+        std::uint32_t code_point = 0x80 + static_cast<std::uint32_t>(rng.below(limit - 0x80));
+        if (code_point >= 0xD800 && code_point <= 0xDFFF) {
+            code_point = 0xFFFD;  // surrogates are not valid in UTF-8
+        }
+        appendUtf8(out, code_point);
+    }
+
+    inline std::string randomText(Random& rng, std::size_t size) {
+        static const char bom[] = "\xEF\xBB\xBF";
+        const char* special = specialCharacters();
+        const std::size_t special_count = std::strlen(special);
+
+        std::string text;
+        if (rng.oneIn(8)) {
+            text.append(bom, 3);
+        }
+        const std::size_t length = rng.below(size + 1);
+        for (std::size_t i = 0; i < length; ++i) {
+            switch (rng.below(8)) {
+            case 0:
+            case 1:
+                text += special[rng.below(special_count)];
+                break;
+            case 2:
+                appendRandomCodePoint(text, rng);
+                break;
+            case 3:
+                // Control characters, including embedded nulls
+                text += static_cast<char>(rng.below(32));
+                break;
+            case 4:
+                if (rng.oneIn(4)) {
+                    text.append(bom, 3);
+                } else {
+                    // Stray byte, possibly starting or breaking a UTF-8 sequence
+                    text += static_cast<char>(0x80 + rng.below(128));
+                }
+                break;
+            default:
+                text += static_cast<char>('a' + rng.below(26));
+                break;
+            }
+        }
+        return text;
+    }
+
+    // Candidates with runs of elements removed, largest runs first
+    template<typename Sequence>
+    inline std::vector<Sequence> shrinkSequence(const Sequence& value) {
+        std::vector<Sequence> candidates;
+        const std::size_t n = value.size();
+        if (n == 0) {
+            return candidates;
+        }
+        candidates.push_back(Sequence());
+        for (std::size_t chunk = n / 2; chunk > 0; chunk /= 2) {
+            for (std::size_t start = 0; start + chunk <= n; start += chunk) {
+                Sequence smaller(value.begin(), value.begin() + static_cast<std::ptrdiff_t>(start));
+                smaller.insert(smaller.end(), value.begin() + static_cast<std::ptrdiff_t>(start + chunk), value.end());
+                candidates.push_back(smaller);
+            }
+        }
+        return candidates;
+    }
+
+    template<typename Tuple, std::size_t I>
+    struct TupleArbitrary {
+        static void generate(Tuple& value, Random& rng, std::size_t size) {
+            TupleArbitrary<Tuple, I - 1>::generate(value, rng, size);
+            std::get<I - 1>(value) = Arbitrary<typename std::tuple_element<I - 1, Tuple>::type>::generate(rng, size);
+        }
+
+        static void shrink(const Tuple& value, std::vector<Tuple>& candidates) {
+            TupleArbitrary<Tuple, I - 1>::shrink(value, candidates);
+            for (const auto& element : Arbitrary<typename std::tuple_element<I - 1, Tuple>::type>::shrink(std::get<I - 1>(value))) {
+                Tuple smaller = value;
+                std::get<I - 1>(smaller) = element;
+                candidates.push_back(smaller);
+            }
+        }
+    };
+
+    template<typename Tuple>
+    struct TupleArbitrary<Tuple, 0> {
+        static void generate(Tuple&, Random&, std::size_t) {}
+        static void shrink(const Tuple&, std::vector<Tuple>&) {}
+    };
+
+    inline std::uint64_t hashName(const char* name) {
+        std::uint64_t hash = 14695981039346656037ULL;  // FNV-1a
+        for (; *name; ++name) {
+            hash = (hash ^ static_cast<unsigned char>(*name)) * 1099511628211ULL;
+        }
+        return hash;
+    }
+
+    inline bool readEnvironment(const char* variable, unsigned long long& value) {
+        const char* text = std::getenv(variable);
+        if (!text || !*text) {
+            return false;
+        }
+        char* end = nullptr;
+        value = std::strtoull(text, &end, 0);
+        return end && *end == '\0';
+    }
+
+    template<typename T>
+    inline std::vector<T> shrinkCandidates(const T& value) {
+        return Arbitrary<T>::shrink(value);
+    }
+
+} // namespace details
+
+template<typename T>
+struct Arbitrary<T, typename std::enable_if<std::is_integral<T>::value && !std::is_same<T, bool>::value>::type> {
+    static T generate(Random& rng, std::size_t size) {
+        switch (rng.below(4)) {
+        case 0: {
+            // Boundaries and their neighbours
+            static const T edges[] = {
+                std::numeric_limits<T>::min(), std::numeric_limits<T>::max(), T(0), T(1),
+                static_cast<T>(std::numeric_limits<T>::min() + 1), static_cast<T>(std::numeric_limits<T>::max() - 1)
+            };
+            return edges[rng.below(sizeof(edges) / sizeof(edges[0]))];
+        }
+        case 1:
+            return static_cast<T>(rng.next());
+        default: {
+            // Small values around zero
+            const T small = static_cast<T>(rng.below(size + 1));
+            return (std::is_signed<T>::value && rng.oneIn(2)) ? static_cast<T>(0 - small) : small;
+        }
+        }
+    }
+
+    static std::vector<T> shrink(const T& value) {
+        std::vector<T> candidates;
+        if (value != T(0)) {
+            candidates.push_back(T(0));
+            if (value / 2 != T(0)) {
+                candidates.push_back(static_cast<T>(value / 2));
+            }
+        }
+        return candidates;
+    }
+};
+
+template<>
+struct Arbitrary<bool> {
+    static bool generate(Random& rng, std::size_t) {
+        return rng.oneIn(2);
+    }
+
+    static std::vector<bool> shrink(bool value) {
+        return value ? std::vector<bool>(1, false) : std::vector<bool>();
+    }
+};
+
+template<>
+struct Arbitrary<double> {
+    static double generate(Random& rng, std::size_t size) {
+        switch (rng.below(4)) {
+        case 0: {
+            static const double edges[] = {
+                0.0, -0.0, 1.0, -1.0, 0.1, 1e-300, 1e300,
+                std::numeric_limits<double>::max(), std::numeric_limits<double>::lowest(),
+                std::numeric_limits<double>::min(), std::numeric_limits<double>::epsilon()
+            };
+            return edges[rng.below(sizeof(edges) / sizeof(edges[0]))];
+        }
+        case 1:
+            // Uniform in [-size, size]
+            return (static_cast<double>(rng.next() >> 11) / 9007199254740992.0 * 2.0 - 1.0) * static_cast<double>(size);
+        default:
+            return static_cast<double>(Arbitrary<int>::generate(rng, size)) / 8.0;
+        }
+    }
+
+    static std::vector<double> shrink(double value) {
+        std::vector<double> candidates;
+        if (value != 0.0) {
+            candidates.push_back(0.0);
+            if (value != static_cast<double>(static_cast<long long>(value)) && value > -1e18 && value < 1e18) {
+                candidates.push_back(static_cast<double>(static_cast<long long>(value)));
+            }
+        }
+        return candidates;
+    }
+};
+
+template<>
+struct Arbitrary<std::string> {
+    static std::string generate(Random& rng, std::size_t size) {
+        return details::randomText(rng, size);
+    }
+
+    static std::vector<std::string> shrink(const std::string& value) {
+        return details::shrinkSequence(value);
+    }
+};
+
+template<typename T>
+struct Arbitrary<std::vector<T> > {
+    static std::vector<T> generate(Random& rng, std::size_t size) {
+        // Nested containers get a smaller size so deep values stay small
+        const std::size_t count = rng.below(size / 2 + 2);
+        std::vector<T> value;
+        value.reserve(count);
+        for (std::size_t i = 0; i < count; ++i) {
+            value.push_back(Arbitrary<T>::generate(rng, size / 2));
+        }
+        return value;
+    }
+
+    static std::vector<std::vector<T> > shrink(const std::vector<T>& value) {
+        return details::shrinkSequence(value);
+    }
+};
+
+template<typename K, typename V>
+struct Arbitrary<std::map<K, V> > {
+    static std::map<K, V> generate(Random& rng, std::size_t size) {
+        const std::size_t count = rng.below(size / 2 + 2);
+        std::map<K, V> value;
+        for (std::size_t i = 0; i < count; ++i) {
+            value[Arbitrary<K>::generate(rng, size / 2)] = Arbitrary<V>::generate(rng, size / 2);
+        }
+        return value;
+    }
+
+    static std::vector<std::map<K, V> > shrink(const std::map<K, V>& value) {
+        std::vector<std::map<K, V> > candidates;
+        if (!value.empty()) {
+            candidates.push_back(std::map<K, V>());
+            for (auto it = value.begin(); it != value.end(); ++it) {
+                std::map<K, V> smaller = value;
+                smaller.erase(it->first);
+                candidates.push_back(smaller);
+            }
+        }
+        return candidates;
+    }
+};
+
+template<typename A, typename B>
+struct Arbitrary<std::pair<A, B> > {
+    static std::pair<A, B> generate(Random& rng, std::size_t size) {
+        A first = Arbitrary<A>::generate(rng, size);
+        return std::pair<A, B>(first, Arbitrary<B>::generate(rng, size));
+    }
+
+    static std::vector<std::pair<A, B> > shrink(const std::pair<A, B>& value) {
+        std::vector<std::pair<A, B> > candidates;
+        for (const auto& first : Arbitrary<A>::shrink(value.first)) {
+            candidates.push_back(std::pair<A, B>(first, value.second));
+        }
+        for (const auto& second : Arbitrary<B>::shrink(value.second)) {
+            candidates.push_back(std::pair<A, B>(value.first, second));
+        }
+        return candidates;
+    }
+};
+
+template<typename... Ts>
+struct Arbitrary<std::tuple<Ts...> > {
+    static std::tuple<Ts...> generate(Random& rng, std::size_t size) {
+        std::tuple<Ts...> value;
+        details::TupleArbitrary<std::tuple<Ts...>, sizeof...(Ts)>::generate(value, rng, size);
+        return value;
+    }
+
+    static std::vector<std::tuple<Ts...> > shrink(const std::tuple<Ts...>& value) {
+        std::vector<std::tuple<Ts...> > candidates;
+        details::TupleArbitrary<std::tuple<Ts...>, sizeof...(Ts)>::shrink(value, candidates);
+        return candidates;
+    }
+};
+
+/**
+ * @brief Settings of one property run
+ */
+struct Config {
+    unsigned long long cases;   ///< Generated values to check
+    std::size_t maxSize;        ///< Size passed to generators for the last case
+    unsigned long maxShrinks;   ///< Upper bound on shrinking steps after a failure
+
+    Config() : cases(1000), maxSize(64), maxShrinks(1000) {}
+};
+
+/**
+ * @brief Outcome of a passing property run
+ */
+struct Stats {
+    unsigned long long cases;
+    double elapsedMs;
+    double casesPerSecond;
+};
+
+namespace details {
+
+    // Failure of a property on one value
+    struct Failure {
+        std::string message;
+        std::string file;
+        int line;
+
+        Failure() : line(0) {}
+    };
+
+    // Runs the property on one value; returns true and fills failure when it fails
+    template<typename T, typename Property>
+    inline bool failsOn(Property& property, const T& value, Failure& failure) {
+        try {
+            property(value);
+            return false;
+        } catch (const AssertionException& e) {
+            failure.message = e.what();
+            failure.file = e.getFile();
+            failure.line = e.getLine();
+        } catch (const std::exception& e) {
+            failure.message = std::string("unexpected exception: ") + e.what();
+        } catch (...) {
+            failure.message = "unknown exception";
+        }
+        return true;
+    }
+
+    // Greedily replaces the counterexample with the first smaller value that still fails
+    template<typename T, typename Property>
+    inline unsigned long shrinkFailure(Property& property, T& value, Failure& failure, unsigned long max_steps) {
+        unsigned long steps = 0;
+        bool progress = true;
+        while (progress && steps < max_steps) {
+            progress = false;
+            for (const auto& candidate : shrinkCandidates(value)) {
+                Failure candidate_failure;
+                if (failsOn(property, candidate, candidate_failure)) {
+                    value = candidate;
+                    failure = candidate_failure;
+                    progress = true;
+                    ++steps;
+                    break;
+                }
+            }
+        }
+        return steps;
+    }
+
+} // namespace details
+
+/**
+ * @brief Check a property against generated values of type T
+ * @param name Property name used in reports
+ * @param property Callable taking `const T&`, failing through UTEST_ASSERT_* or any exception
+ * @param config Number of cases and generated value sizes
+ * @return Number of cases and throughput
+ *
+ * On failure the smallest failing value found is reported in an
+ * AssertionException, so forAll can be called from any test body.
+ */
+template<typename T, typename Property>
+Stats forAll(const char* name, Property property, Config config = Config()) {
+    unsigned long long seed = details::hashName(name);
+    unsigned long long env_value = 0;
+    details::readEnvironment("UTEST_PROP_SEED", seed);
+    if (details::readEnvironment("UTEST_PROP_CASES", env_value) && env_value > 0) {
+        config.cases = env_value;
+    }
+
+    Random rng(seed);
+    const auto start = std::chrono::steady_clock::now();
+    for (unsigned long long i = 0; i < config.cases; ++i) {
+        const std::size_t size = static_cast<std::size_t>(1 + i * config.maxSize / config.cases);
+        T value = Arbitrary<T>::generate(rng, size);
+        details::Failure failure;
+        if (details::failsOn(property, value, failure)) {
+            const unsigned long steps = details::shrinkFailure(property, value, failure, config.maxShrinks);
+            std::ostringstream ss;
+            ss << "Property '" << name << "' failed after " << (i + 1) << " cases (UTEST_PROP_SEED="
+               << seed << ", shrunk " << steps << " times): " << failure.message
+               << "; counterexample: " << ::utest::details::convertToString(value);
+            if (failure.file.empty()) {
+                throw AssertionException(ss.str(), __FILE__, __LINE__, name);
+            }
+            throw AssertionException(ss.str(), failure.file, failure.line, name);
+        }
+    }
+    const auto end = std::chrono::steady_clock::now();
+
+    Stats stats;
+    stats.cases = config.cases;
+    stats.elapsedMs = std::chrono::duration<double, std::milli>(end - start).count();
+    stats.casesPerSecond = stats.elapsedMs > 0.0 ? static_cast<double>(stats.cases) * 1000.0 / stats.elapsedMs : 0.0;
+    if (::utest::details::getVerboseMode()) {
+        std::cout << "Property " << name << ": " << stats.cases << " cases in "
+                  << std::fixed << std::setprecision(1) << stats.elapsedMs << " ms ("
+                  << std::setprecision(0) << stats.casesPerSecond << " cases/sec)\n";
+        std::cout.unsetf(std::ios::floatfield);
+        std::cout << std::setprecision(6);
+    }
+    return stats;
+}
+
+} // namespace prop
+} // namespace utest
+
+#endif // __UTEST_PROP_H__
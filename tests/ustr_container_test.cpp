@@ -4,6 +4,30 @@
 #include <string>
 #include <map>
 #include <array>
+#include <limits>
+#if __cplusplus >= 202002L && __has_include(<span>)
+#include <span>
+#endif
+
+// Range exposing only begin()/end()
+class IntRangeView {
+    const int* first_;
+    const int* last_;
+public:
+    IntRangeView(const int* first, const int* last) : first_(first), last_(last) {}
+    const int* begin() const { return first_; }
+    const int* end() const { return last_; }
+};
+
+// Contiguous buffer exposing only data()/size()
+template<typename T>
+class Buffer {
+    std::vector<T> items_;
+public:
+    explicit Buffer(std::vector<T> items) : items_(std::move(items)) {}
+    const T* data() const { return items_.data(); }
+    std::size_t size() const { return items_.size(); }
+};
 
 // Test iterator-based to_string function
 UTEST_FUNC_DEF2(IteratorConversion, VectorOfInts) {
@@ -146,29 +170,122 @@ UTEST_FUNC_DEF2(IteratorConversion, QuotationComprehensiveTest) {
     UTEST_ASSERT_STR_EQUALS(stringIntMapResult, "{\"count\": 5}");
 }
 
-int main() {
-    UTEST_PROLOG();
-    UTEST_ENABLE_VERBOSE_MODE();
+// Test join with custom delimiters
+UTEST_FUNC_DEF2(Join, SeparatorOnly) {
+    std::vector<int> values = {1, 2, 3};
+    UTEST_ASSERT_STR_EQUALS(ustr::join(values, ","), "1,2,3");
+    UTEST_ASSERT_STR_EQUALS(ustr::join(values, " "), "1 2 3");
+}
+
+UTEST_FUNC_DEF2(Join, OpenCloseDelimiters) {
+    std::vector<int> values = {1, 2, 3};
+    UTEST_ASSERT_STR_EQUALS(ustr::join(values, " ", "<", ">"), "<1 2 3>");
+    std::vector<int> empty;
+    UTEST_ASSERT_STR_EQUALS(ustr::join(empty, ",", "(", ")"), "()");
+}
+
+UTEST_FUNC_DEF2(Join, StringsNotQuoted) {
+    std::vector<std::string> values = {"a", "b c", "d"};
+    UTEST_ASSERT_STR_EQUALS(ustr::join(values, ","), "a,b c,d");
+}
+
+UTEST_FUNC_DEF2(Join, RangeFormatWithQuoting) {
+    std::map<std::string, std::string> labels = {{"env", "prod"}, {"job", "api"}};
+    std::string result = ustr::join(labels, ustr::range_format(",", "{", "}", "="));
+    UTEST_ASSERT_STR_EQUALS(result, "{\"env\"=\"prod\",\"job\"=\"api\"}");
+}
+
+UTEST_FUNC_DEF2(Join, CArray) {
+    int values[] = {4, 5, 6};
+    UTEST_ASSERT_STR_EQUALS(ustr::join(values, "|"), "4|5|6");
+}
+
+UTEST_FUNC_DEF2(Join, QuotedElementsAreEscaped) {
+    std::vector<std::string> values = {"say \"hi\""};
+    UTEST_ASSERT_STR_EQUALS(ustr::to_string(values), "[\"say \\\"hi\\\"\"]");
+}
+
+// Test contiguous numeric fast path
+UTEST_FUNC_DEF2(ContiguousNumeric, IntegerLimits) {
+    std::vector<int> ints = {std::numeric_limits<int>::min(), -1, 0, 9, 10, 99, 100, std::numeric_limits<int>::max()};
+    std::string expected = "[";
+    for (std::size_t i = 0; i < ints.size(); ++i) {
+        if (i != 0) {
+            expected += ", ";
+        }
+        expected += std::to_string(ints[i]);
+    }
+    expected += "]";
+    UTEST_ASSERT_STR_EQUALS(ustr::to_string(ints), expected);
     
-    // Iterator conversion tests
-    UTEST_FUNC2(IteratorConversion, VectorOfInts);
-    UTEST_FUNC2(IteratorConversion, EmptyContainer);
-    UTEST_FUNC2(IteratorConversion, VectorOfStrings);
-    UTEST_FUNC2(IteratorConversion, MapContainerStringKeys);
-    UTEST_FUNC2(IteratorConversion, MapContainerNumericKeys);
-    UTEST_FUNC2(IteratorConversion, MapContainerDoubleKeys);
-    UTEST_FUNC2(IteratorConversion, ArrayContainer);
-    UTEST_FUNC2(IteratorConversion, ArrayContainerStrings);
-    UTEST_FUNC2(IteratorConversion, MapWithMixedValueTypes);
-    UTEST_FUNC2(IteratorConversion, QuotationComprehensiveTest);
+    std::vector<unsigned long long> big = {0ull, std::numeric_limits<unsigned long long>::max()};
+    UTEST_ASSERT_STR_EQUALS(ustr::to_string(big),
+                            "[0, " + std::to_string(std::numeric_limits<unsigned long long>::max()) + "]");
+}
+
+UTEST_FUNC_DEF2(ContiguousNumeric, IteratorSubrangeAndEmpty) {
+    std::vector<short> values = {1, 2, 3, 4};
+    UTEST_ASSERT_STR_EQUALS(ustr::to_string(values.begin() + 1, values.end() - 1), "[2, 3]");
+    UTEST_ASSERT_STR_EQUALS(ustr::to_string(values.cbegin(), values.cbegin()), "[]");
+    
+    const double reals[] = {1.5, -0.25};
+    UTEST_ASSERT_STR_EQUALS(ustr::to_string(reals), "[1.500000, -0.250000]");
+    UTEST_ASSERT_STR_EQUALS(ustr::join(values, ";"), "1;2;3;4");
+    
+    std::array<long, 2> arr = {{-7, 8}};
+    UTEST_ASSERT_STR_EQUALS(ustr::to_string(arr), "[-7, 8]");
+}
+
+// Test ranges without cbegin/cend
+UTEST_FUNC_DEF2(PlainRanges, BeginEndOnly) {
+    const int values[] = {1, 2, 3};
+    IntRangeView view(values, values + 3);
+    UTEST_ASSERT_STR_EQUALS(ustr::to_string(view), "[1, 2, 3]");
+    UTEST_ASSERT_STR_EQUALS(ustr::to_string(IntRangeView(values, values)), "[]");
+}
+
+UTEST_FUNC_DEF2(PlainRanges, DataSizeOnly) {
+    Buffer<long> numbers(std::vector<long>{-5, 0, std::numeric_limits<long>::max()});
+    UTEST_ASSERT_STR_EQUALS(ustr::to_string(numbers),
+                            "[-5, 0, " + std::to_string(std::numeric_limits<long>::max()) + "]");
     
-    // cbegin/cend specialization tests
-    UTEST_FUNC2(CBeginCEndSpecialization, VectorSpecialization);
-    UTEST_FUNC2(CBeginCEndSpecialization, StringSpecialization);
-    UTEST_FUNC2(CBeginCEndSpecialization, MapSpecializationStringKeys);
-    UTEST_FUNC2(CBeginCEndSpecialization, MapSpecializationNumericKeys);
-    UTEST_FUNC2(CBeginCEndSpecialization, EmptyVectorSpecialization);
-    UTEST_FUNC2(CBeginCEndSpecialization, ArraySpecialization);
+    Buffer<double> reals(std::vector<double>{0.5, -1.25});
+    UTEST_ASSERT_STR_EQUALS(ustr::to_string(reals), "[0.500000, -1.250000]");
     
+    Buffer<std::string> words(std::vector<std::string>{"a", "b"});
+    UTEST_ASSERT_STR_EQUALS(ustr::to_string(words), "[\"a\", \"b\"]");
+}
+
+UTEST_FUNC_DEF2(PlainRanges, LargeNumericBuffer) {
+    std::vector<int> source;
+    std::string expected = "[";
+    for (int i = -600; i < 600; ++i) {
+        source.push_back(i * 12345);
+        if (i != -600) {
+            expected += ", ";
+        }
+        expected += std::to_string(i * 12345);
+    }
+    expected += "]";
+    Buffer<int> buffer(source);
+    UTEST_ASSERT_STR_EQUALS(ustr::to_string(buffer), expected);
+}
+
+#if __cplusplus >= 202002L && defined(__cpp_lib_span)
+UTEST_FUNC_DEF2(PlainRanges, Span) {
+    std::vector<int> values = {4, 5, 6};
+    std::span<const int> numbers(values);
+    UTEST_ASSERT_STR_EQUALS(ustr::to_string(numbers), "[4, 5, 6]");
+    
+    std::vector<std::string> words = {"x", "y"};
+    std::span<const std::string> text(words);
+    UTEST_ASSERT_STR_EQUALS(ustr::to_string(text), "[\"x\", \"y\"]");
+}
+#endif
+
+int main(int argc, char* argv[]) {
+    UTEST_PROLOG(argc, argv);
+    UTEST_ENABLE_VERBOSE_MODE();
+    UTEST_RUN_REGISTERED();
     UTEST_EPILOG();
 }
@@ -4,10 +4,14 @@
 #include <sstream>
 #include <map>
 #include <iomanip>  // for std::setprecision
+#include <memory>
 
-// Include string_view for C++17 and later
+// Include string_view and vocabulary types for C++17 and later
 #if __cplusplus >= 201703L
 #include <string_view>
+#include <optional>
+#include <variant>
+#include <any>
 #endif
 
 // Test classes for different scenarios
@@ -119,27 +123,6 @@ UTEST_FUNC_DEF2(StringConversion, StringViewSubstring) {
 }
 #endif // __cplusplus >= 201703L
 
-// These tests have been moved to ustr_custom_classes_test.cpp
-// but we keep the declarations to avoid compilation errors
-UTEST_FUNC_DEF2(CustomToStringTest, BasicUsage) {
-    CustomToString obj(42);
-    std::string result = ustr::to_string(obj);
-    UTEST_ASSERT_STR_EQUALS(result, "CustomToString(42)");
-}
-
-UTEST_FUNC_DEF2(CustomToStringTest, PrecedenceOverStreamable) {
-    BothMethods obj(123);
-    std::string result = ustr::to_string(obj);
-    UTEST_ASSERT_STR_EQUALS(result, "to_string_method:123");
-}
-
-// Test streamable classes
-UTEST_FUNC_DEF2(StreamableTest, BasicStreamable) {
-    StreamableClass obj("test");
-    std::string result = ustr::to_string(obj);
-    UTEST_ASSERT_STR_EQUALS(result, "StreamableClass[test]");
-}
-
 // Test numeric types
 UTEST_FUNC_DEF2(NumericTypes, Integer) {
     int value = 42;
@@ -220,20 +203,6 @@ UTEST_FUNC_DEF2(BooleanType, False) {
     UTEST_ASSERT_STR_EQUALS(result, "false");
 }
 
-// Test non-streamable classes - moved to ustr_custom_classes_test.cpp
-UTEST_FUNC_DEF2(NonStreamableTest, TypeInfo) {
-    NonStreamableClass obj(42);
-    std::string result = ustr::to_string(obj);
-    
-    // Should contain type name and address
-    UTEST_ASSERT_TRUE(result.find("[") == 0);
-    UTEST_ASSERT_TRUE(result.find("NonStreamableClass") != std::string::npos || 
-                     result.find("16NonStreamableClass") != std::string::npos ||  // mangled name variant
-                     result.find("N") != std::string::npos);  // some part of mangled name
-    UTEST_ASSERT_TRUE(result.find(" at ") != std::string::npos);
-    UTEST_ASSERT_TRUE(result.find("]") == result.length() - 1);
-}
-
 // Test type trait detection - custom class tests moved to ustr_custom_classes_test.cpp
 UTEST_FUNC_DEF2(TypeTraits, HasToString) {
     UTEST_ASSERT_FALSE(ustr::has_to_string<int>::value);
@@ -413,60 +382,75 @@ UTEST_FUNC_DEF2(CStyleArrays, MixedTypeArrayWithString) {
     UTEST_ASSERT_STR_EQUALS(result, "[\"first\", \"second\"]");
 }
 
-int main() {
-    UTEST_PROLOG();
-    UTEST_ENABLE_VERBOSE_MODE();
-    
-    // String conversion tests
-    UTEST_FUNC2(StringConversion, StdString);
-    UTEST_FUNC2(StringConversion, StringLiteral);
-    UTEST_FUNC2(StringConversion, CharArray);
-#if __cplusplus >= 201703L
-    UTEST_FUNC2(StringConversion, BasicStringView);
-    UTEST_FUNC2(StringConversion, StringViewFromString);
-    UTEST_FUNC2(StringConversion, StringViewSubstring);
-#endif
+// Test smart pointers: pointee or null
+UTEST_FUNC_DEF2(ValueWrappers, SmartPointers) {
+    std::unique_ptr<int> empty;
+    std::unique_ptr<int> number(new int(42));
+    std::shared_ptr<std::string> text = std::make_shared<std::string>("abc");
+    std::shared_ptr<std::string> no_text;
     
-    // Numeric type tests
-    UTEST_FUNC2(NumericTypes, Integer);
-    UTEST_FUNC2(NumericTypes, NegativeInteger);
-    UTEST_FUNC2(NumericTypes, Float);
-    UTEST_FUNC2(NumericTypes, Double);
-    UTEST_FUNC2(NumericTypes, Long);
-    UTEST_FUNC2(NumericTypes, UnsignedInt);
+    UTEST_ASSERT_STR_EQUALS(ustr::to_string(empty), "null");
+    UTEST_ASSERT_STR_EQUALS(ustr::to_string(number), "42");
+    UTEST_ASSERT_STR_EQUALS(ustr::to_string(text), "abc");
+    UTEST_ASSERT_STR_EQUALS(ustr::to_string(no_text), "null");
+}
+
+UTEST_FUNC_DEF2(ValueWrappers, SmartPointersInContainers) {
+    std::vector<std::shared_ptr<std::string>> items;
+    items.push_back(std::make_shared<std::string>("a"));
+    items.push_back(nullptr);
+    // Contained strings are quoted like plain string elements
+    UTEST_ASSERT_STR_EQUALS(ustr::to_string(items), "[\"a\", null]");
     
-    // Character type tests
-    UTEST_FUNC2(CharacterTypes, RegularChar);
-    UTEST_FUNC2(CharacterTypes, SignedChar);
-    UTEST_FUNC2(CharacterTypes, UnsignedChar);
-    UTEST_FUNC2(CharacterTypes, SpecialChars);
-    
-    // Boolean tests
-    UTEST_FUNC2(BooleanType, True);
-    UTEST_FUNC2(BooleanType, False);
+    std::string out = "ptr=";
+    ustr::append_to(out, std::unique_ptr<double>(new double(1.5)));
+    UTEST_ASSERT_STR_EQUALS(out, "ptr=1.500000");
+}
+
+#if __cplusplus >= 201703L
+UTEST_FUNC_DEF2(ValueWrappers, Optional) {
+    std::optional<int> empty;
+    std::optional<int> value = 7;
+    std::optional<std::string> text = std::string("hi");
     
-    // Type trait tests
-    UTEST_FUNC2(TypeTraits, HasToString);
-    UTEST_FUNC2(TypeTraits, IsStreamable);
-    UTEST_FUNC2(TypeTraits, IsNumeric);
-    UTEST_FUNC2(TypeTraits, IsQuotableString);
-    UTEST_FUNC2(TypeTraits, HasCBeginCEnd);
-    UTEST_FUNC2(TypeTraits, IsCArray);
+    UTEST_ASSERT_STR_EQUALS(ustr::to_string(empty), "null");
+    UTEST_ASSERT_STR_EQUALS(ustr::to_string(value), "7");
+    UTEST_ASSERT_STR_EQUALS(ustr::to_string(text), "hi");
     
-    // Edge case tests
-    UTEST_FUNC2(EdgeCases, EmptyString);
-    UTEST_FUNC2(EdgeCases, ZeroValues);
-    UTEST_FUNC2(EdgeCases, NullCharPointer);
-    UTEST_FUNC2(EdgeCases, NullptrType);
+    std::vector<std::optional<std::string>> items = {std::string("x"), std::nullopt};
+    UTEST_ASSERT_STR_EQUALS(ustr::to_string(items), "[\"x\", null]");
+}
+
+UTEST_FUNC_DEF2(ValueWrappers, Variant) {
+    std::variant<int, std::string, double> v = 3;
+    UTEST_ASSERT_STR_EQUALS(ustr::to_string(v), "3");
+    v = std::string("three");
+    UTEST_ASSERT_STR_EQUALS(ustr::to_string(v), "three");
+    v = 3.5;
+    UTEST_ASSERT_STR_EQUALS(ustr::to_string(v), "3.500000");
     
-    // C-style array tests
-    UTEST_FUNC2(CStyleArrays, IntArray);
-    UTEST_FUNC2(CStyleArrays, DoubleArray);
-    UTEST_FUNC2(CStyleArrays, StringArray);
-    UTEST_FUNC2(CStyleArrays, BoolArray);
-    UTEST_FUNC2(CStyleArrays, CharArrayAsCString);
-    UTEST_FUNC2(CStyleArrays, SingleElementArray);
-    UTEST_FUNC2(CStyleArrays, MixedTypeArrayWithString);
+    std::variant<std::monostate, int> none;
+    UTEST_ASSERT_STR_EQUALS(ustr::to_string(none), "null");
+    UTEST_ASSERT_STR_EQUALS(ustr::to_string(std::monostate()), "null");
+    UTEST_ASSERT_FALSE(ustr::details::is_variant<std::monostate>::value);
+    UTEST_ASSERT_TRUE(ustr::details::is_monostate<std::monostate>::value);
     
+    std::map<std::string, std::variant<int, std::string>> fields = {{"a", 1}, {"b", std::string("x")}};
+    UTEST_ASSERT_STR_EQUALS(ustr::to_string(fields), "{\"a\": 1, \"b\": \"x\"}");
+}
+
+UTEST_FUNC_DEF2(ValueWrappers, Any) {
+    std::any empty;
+    UTEST_ASSERT_STR_EQUALS(ustr::to_string(empty), "null");
+    UTEST_ASSERT_STR_EQUALS(ustr::to_string(std::any(12)), "12");
+    UTEST_ASSERT_STR_EQUALS(ustr::to_string(std::any(std::string("s"))), "s");
+    UTEST_ASSERT_STR_EQUALS(ustr::to_string(std::any(NonStreamableClass(1))), "[any]");
+}
+#endif // __cplusplus >= 201703L
+
+int main(int argc, char* argv[]) {
+    UTEST_PROLOG(argc, argv);
+    UTEST_ENABLE_VERBOSE_MODE();
+    UTEST_RUN_REGISTERED();
     UTEST_EPILOG();
 }
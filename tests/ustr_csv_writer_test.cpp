@@ -0,0 +1,173 @@
+#include "../include/ustr/csv_writer.h"
+#include "../include/utest/utest.h"
+#include <vector>
+#include <string>
+#include <tuple>
+#include <sstream>
+#include <cstdio>
+
+// Struct exposing its fields through as_tuple()
+struct CsvTrade {
+    int id;
+    std::string symbol;
+    double price;
+
+    std::tuple<const int&, const std::string&, const double&> as_tuple() const {
+        return std::tie(id, symbol, price);
+    }
+};
+
+// Aggregate registered for field-by-field conversion
+struct CsvQuote {
+    std::string symbol;
+    int bid;
+    int ask;
+};
+USTR_REFLECT(CsvQuote, symbol, bid, ask)
+
+// Test basic row output
+UTEST_FUNC_DEF2(CsvWriter, TupleRows) {
+    std::string out;
+    {
+        ustr::csv_writer writer(out);
+        std::vector<std::tuple<int, std::string, bool>> rows = {
+            std::make_tuple(1, std::string("alpha"), true),
+            std::make_tuple(-2, std::string("beta"), false)
+        };
+        writer.write_rows(rows);
+        UTEST_ASSERT_EQUALS(writer.rows_written(), 2u);
+    }
+    UTEST_ASSERT_STR_EQUALS(out, "1,alpha,true\n-2,beta,false\n");
+}
+
+UTEST_FUNC_DEF2(CsvWriter, PairRows) {
+    std::string out;
+    ustr::csv_writer writer(out);
+    writer.write_row(std::make_pair(std::string("key"), 42));
+    UTEST_ASSERT_STR_EQUALS(out, "key,42\n");
+}
+
+UTEST_FUNC_DEF2(CsvWriter, StructWithTupleView) {
+    std::string out;
+    ustr::csv_writer writer(out);
+    std::vector<CsvTrade> trades = {{1, "ABC", 1.5}, {2, "XYZ", 20.25}};
+    writer.write_fields("id", "symbol", "price");
+    writer.write_rows(trades);
+    UTEST_ASSERT_STR_EQUALS(out, "id,symbol,price\n1,ABC,1.500000\n2,XYZ,20.250000\n");
+}
+
+UTEST_FUNC_DEF2(CsvWriter, ReflectedStruct) {
+    std::string out;
+    ustr::csv_writer writer(out);
+    std::vector<CsvQuote> quotes = {{"ABC", 10, 11}, {"X,Y", 5, 6}};
+    writer.write_header<CsvQuote>();
+    writer.write_rows(quotes);
+    UTEST_ASSERT_STR_EQUALS(out, "symbol,bid,ask\nABC,10,11\n\"X,Y\",5,6\n");
+}
+
+// Test RFC 4180 quoting
+UTEST_FUNC_DEF2(CsvWriter, QuotingOnlyWhenNeeded) {
+    std::string out;
+    ustr::csv_writer writer(out);
+    writer.write_fields("plain", "with,comma", "with \"quote\"", "line\nbreak");
+    UTEST_ASSERT_STR_EQUALS(out, "plain,\"with,comma\",\"with \"\"quote\"\"\",\"line\nbreak\"\n");
+}
+
+UTEST_FUNC_DEF2(CsvWriter, QuotingNonStringFields) {
+    std::string out;
+    ustr::csv_writer writer(out);
+    std::vector<int> values = {1, 2};
+    writer.write_fields(',', values);
+    UTEST_ASSERT_STR_EQUALS(out, "\",\",\"[1, 2]\"\n");
+}
+
+UTEST_FUNC_DEF2(CsvWriter, TabSeparated) {
+    std::string out;
+    ustr::csv_writer writer(out, ustr::csv_options('\t'));
+    writer.write_fields("a,b", "c\td", 3);
+    UTEST_ASSERT_STR_EQUALS(out, "a,b\t\"c\td\"\t3\n");
+}
+
+// Test buffered targets and chunked flushes
+UTEST_FUNC_DEF2(CsvWriter, StreamTargetChunkedFlush) {
+    std::ostringstream stream;
+    {
+        ustr::csv_writer writer(stream, ustr::csv_options(',', '"', "\r\n", 16));
+        for (int i = 0; i < 10; ++i) {
+            writer.write_fields(i, "row");
+        }
+        // Threshold is small, so most rows must already be in the stream
+        UTEST_ASSERT_TRUE(stream.str().size() >= 16u);
+    }
+    std::string expected;
+    for (int i = 0; i < 10; ++i) {
+        expected += std::to_string(i) + ",row\r\n";
+    }
+    UTEST_ASSERT_STR_EQUALS(stream.str(), expected);
+}
+
+UTEST_FUNC_DEF2(CsvWriter, FileTarget) {
+    std::FILE* file = std::tmpfile();
+    UTEST_ASSERT_TRUE(file != nullptr);
+    {
+        ustr::csv_writer writer(file);
+        writer.write_fields("x", 1.25f);
+    }
+    std::rewind(file);
+    char buffer[64] = {0};
+    std::size_t size = std::fread(buffer, 1, sizeof(buffer) - 1, file);
+    std::fclose(file);
+    UTEST_ASSERT_STR_EQUALS(std::string(buffer, size), "x,1.250000\n");
+}
+
+UTEST_FUNC_DEF2(CsvWriter, NullCString) {
+    std::string out;
+    ustr::csv_writer writer(out);
+    const char* missing = nullptr;
+    writer.write_fields(missing, "x");
+    UTEST_ASSERT_STR_EQUALS(out, "null,x\n");
+}
+
+UTEST_FUNC_DEF2(CsvWriter, ReportsStreamFailure) {
+    std::ostringstream stream;
+    ustr::csv_writer writer(stream);
+    writer.write_fields(1, "a");
+    UTEST_ASSERT_TRUE(writer.flush());
+    UTEST_ASSERT_TRUE(writer.good());
+
+    stream.setstate(std::ios::badbit);
+    writer.write_fields(2, "b");
+    UTEST_ASSERT_FALSE(writer.flush());
+    UTEST_ASSERT_FALSE(writer.good());
+    // The failure is sticky
+    stream.clear();
+    writer.write_fields(3, "c");
+    UTEST_ASSERT_FALSE(writer.flush());
+    UTEST_ASSERT_EQUALS(writer.rows_written(), 3u);
+}
+
+UTEST_FUNC_DEF2(CsvWriter, ReportsFileFailure) {
+    // /dev/full accepts opening but fails every write (Linux)
+    std::FILE* file = std::fopen("/dev/full", "w");
+    if (!file) {
+        return;
+    }
+    bool flushed = true;
+    bool good = true;
+    {
+        ustr::csv_writer writer(file);
+        writer.write_fields("x", 1);
+        flushed = writer.flush();
+        good = writer.good();
+    }
+    std::fclose(file);
+    UTEST_ASSERT_FALSE(flushed);
+    UTEST_ASSERT_FALSE(good);
+}
+
+int main(int argc, char* argv[]) {
+    UTEST_PROLOG(argc, argv);
+    UTEST_ENABLE_VERBOSE_MODE();
+    UTEST_RUN_REGISTERED();
+    UTEST_EPILOG();
+}
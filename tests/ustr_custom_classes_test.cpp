@@ -3,6 +3,7 @@
 #include <vector>
 #include <sstream>
 #include <map>
+#include <cstdint>
 
 // Test classes for different scenarios
 
@@ -51,6 +52,40 @@ public:
     }
 };
 
+// Aggregates registered for field-by-field conversion
+struct ReflectedPoint {
+    int x;
+    int y;
+};
+USTR_REFLECT(ReflectedPoint, x, y)
+
+namespace shapes {
+struct Shape {
+    std::string name;
+    ReflectedPoint origin;
+    std::vector<double> sides;
+    bool filled;
+};
+USTR_REFLECT(Shape, name, origin, sides, filled)
+}
+
+#if __cplusplus >= 201402L
+// The field table is a constant expression from C++14
+constexpr auto reflected_point_fields = ustr_reflect_fields(static_cast<const ReflectedPoint*>(nullptr));
+static_assert(std::tuple_size<decltype(reflected_point_fields)>::value == 2, "two reflected fields");
+static_assert(std::get<1>(reflected_point_fields).name[0] == 'y', "fields in declaration order");
+static_assert(std::get<1>(reflected_point_fields).member == &ReflectedPoint::y, "member pointer of y");
+#endif
+
+// Reflected type that also provides to_string (to_string should take precedence)
+struct ReflectedWithToString {
+    int value;
+    std::string to_string() const {
+        return "custom:" + std::to_string(value);
+    }
+};
+USTR_REFLECT(ReflectedWithToString, value)
+
 // Test custom to_string method
 UTEST_FUNC_DEF2(CustomToStringTest, BasicUsage) {
     CustomToString obj(42);
@@ -85,6 +120,73 @@ UTEST_FUNC_DEF2(NonStreamableTest, TypeInfo) {
     UTEST_ASSERT_TRUE(result.find("]") == result.length() - 1);
 }
 
+UTEST_FUNC_DEF2(NonStreamableTest, AddressAndCachedName) {
+    NonStreamableClass first(1);
+    NonStreamableClass second(2);
+    std::string a = ustr::to_string(first);
+    std::string b = ustr::to_string(second);
+    
+    // Same type name for both objects, different addresses
+    UTEST_ASSERT_STR_EQUALS(a.substr(0, a.find(" at ")), b.substr(0, b.find(" at ")));
+    UTEST_ASSERT_STR_NOT_EQUALS(a, b);
+    
+    std::ostringstream expected_address;
+    expected_address << std::hex << reinterpret_cast<std::uintptr_t>(&first);
+    UTEST_ASSERT_TRUE(a.find(" at 0x" + expected_address.str() + "]") != std::string::npos);
+#if defined(__GNUG__)
+    UTEST_ASSERT_TRUE(a.find("[NonStreamableClass at 0x") == 0);
+#endif
+}
+
+// Test type names extracted from the compiler signature
+UTEST_FUNC_DEF2(TypeNameTest, BasicTypes) {
+    UTEST_ASSERT_STR_EQUALS(ustr::type_name<int>(), "int");
+    UTEST_ASSERT_STR_EQUALS(ustr::type_name<double>(), "double");
+    // Cached: the same string object is returned every time
+    UTEST_ASSERT_TRUE(&ustr::type_name<int>() == &ustr::type_name<int>());
+#if __cplusplus >= 201703L && (defined(__clang__) || defined(__GNUC__))
+    static_assert(ustr::type_name_view<int>() == "int", "compile-time type name");
+    static_assert(ustr::type_name_view<shapes::Shape>() == "shapes::Shape", "compile-time type name");
+#endif
+}
+
+UTEST_FUNC_DEF2(TypeNameTest, UserTypes) {
+#if defined(__clang__) || defined(__GNUC__)
+    UTEST_ASSERT_STR_EQUALS(ustr::type_name<NonStreamableClass>(), "NonStreamableClass");
+    UTEST_ASSERT_STR_EQUALS(ustr::type_name<shapes::Shape>(), "shapes::Shape");
+    UTEST_ASSERT_STR_EQUALS(ustr::type_name<std::vector<int>*>(), ustr::type_name<std::vector<int> >() + "*");
+    UTEST_ASSERT_STR_EQUALS(utest::details::typeName<shapes::Shape>(), "shapes::Shape");
+#endif
+    UTEST_ASSERT_TRUE(ustr::type_name<NonStreamableClass>().find("NonStreamableClass") != std::string::npos);
+}
+
+// Test reflected aggregates
+UTEST_FUNC_DEF2(ReflectTest, BasicFields) {
+    ReflectedPoint p = {1, -2};
+    UTEST_ASSERT_STR_EQUALS(ustr::to_string(p), "{x: 1, y: -2}");
+}
+
+UTEST_FUNC_DEF2(ReflectTest, NestedFieldsInNamespace) {
+    shapes::Shape shape = {"tri", {0, 1}, {3.0, 4.0, 5.0}, true};
+    UTEST_ASSERT_STR_EQUALS(ustr::to_string(shape),
+        "{name: \"tri\", origin: {x: 0, y: 1}, sides: [3.000000, 4.000000, 5.000000], filled: true}");
+
+    std::vector<ReflectedPoint> points = {{1, 2}, {3, 4}};
+    UTEST_ASSERT_STR_EQUALS(ustr::to_string(points), "[{x: 1, y: 2}, {x: 3, y: 4}]");
+}
+
+UTEST_FUNC_DEF2(ReflectTest, ToStringTakesPrecedence) {
+    ReflectedWithToString obj = {5};
+    UTEST_ASSERT_STR_EQUALS(ustr::to_string(obj), "custom:5");
+}
+
+UTEST_FUNC_DEF2(ReflectTest, TypeTrait) {
+    UTEST_ASSERT_TRUE(ustr::details::is_reflectable<ReflectedPoint>::value);
+    UTEST_ASSERT_TRUE(ustr::details::is_reflectable<shapes::Shape>::value);
+    UTEST_ASSERT_FALSE(ustr::details::is_reflectable<NonStreamableClass>::value);
+    UTEST_ASSERT_FALSE(ustr::details::is_reflectable<int>::value);
+}
+
 // Test type trait detection
 UTEST_FUNC_DEF2(TypeTraits, CustomClassesToString) {
     UTEST_ASSERT_TRUE(ustr::has_to_string<CustomToString>::value);
@@ -106,24 +208,9 @@ UTEST_FUNC_DEF2(TypeTraits, CustomClassesNumeric) {
     UTEST_ASSERT_FALSE(ustr::is_numeric<NonStreamableClass>::value);
 }
 
-int main() {
-    UTEST_PROLOG();
+int main(int argc, char* argv[]) {
+    UTEST_PROLOG(argc, argv);
     UTEST_ENABLE_VERBOSE_MODE();
-    
-    // Custom to_string tests
-    UTEST_FUNC2(CustomToStringTest, BasicUsage);
-    UTEST_FUNC2(CustomToStringTest, PrecedenceOverStreamable);
-    
-    // Streamable class tests
-    UTEST_FUNC2(StreamableTest, BasicStreamable);
-    
-    // Non-streamable tests
-    UTEST_FUNC2(NonStreamableTest, TypeInfo);
-    
-    // Type trait tests
-    UTEST_FUNC2(TypeTraits, CustomClassesToString);
-    UTEST_FUNC2(TypeTraits, CustomClassesStreamable);
-    UTEST_FUNC2(TypeTraits, CustomClassesNumeric);
-    
+    UTEST_RUN_REGISTERED();
     UTEST_EPILOG();
 }
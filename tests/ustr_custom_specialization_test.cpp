@@ -173,25 +173,9 @@ UTEST_FUNC_DEF2(CustomSpecialization, CompareWithRegularVector) {
     UTEST_ASSERT_TRUE(regular_result != custom_result);
 }
 
-int main() {
-    UTEST_PROLOG();
+int main(int argc, char* argv[]) {
+    UTEST_PROLOG(argc, argv);
     UTEST_ENABLE_VERBOSE_MODE();
-    
-    // Custom specialization tests
-    UTEST_FUNC2(CustomSpecialization, LongLongSpecialization);
-    UTEST_FUNC2(CustomSpecialization, LongLongZero);
-    UTEST_FUNC2(CustomSpecialization, LongLongNegative);
-    UTEST_FUNC2(CustomSpecialization, ListSpecializationInts);
-    UTEST_FUNC2(CustomSpecialization, ListSpecializationStrings);
-    UTEST_FUNC2(CustomSpecialization, ListSpecializationEmpty);
-    UTEST_FUNC2(CustomSpecialization, ListSpecializationSingleElement);
-    
-    // Type trait tests
-    UTEST_FUNC2(TypeTraits, HasCustomSpecialization);
-    
-    // Comparison tests
-    UTEST_FUNC2(CustomSpecialization, CompareWithRegularLong);
-    UTEST_FUNC2(CustomSpecialization, CompareWithRegularVector);
-    
+    UTEST_RUN_REGISTERED();
     UTEST_EPILOG();
 }
@@ -139,34 +139,9 @@ UTEST_FUNC_DEF2(EnumConversion, MixedContainers) {
     UTEST_ASSERT_STR_EQUALS(ustr::to_string(mixed), "{1: 0, 2: 1}");
 }
 
-int main() {
-    UTEST_PROLOG();
+int main(int argc, char* argv[]) {
+    UTEST_PROLOG(argc, argv);
     UTEST_ENABLE_VERBOSE_MODE();
-    
-    // Type trait tests
-    UTEST_FUNC2(TypeTraits, IsEnum);
-    
-    // Basic enum conversion tests
-    UTEST_FUNC2(EnumConversion, BasicEnum);
-    UTEST_FUNC2(EnumConversion, ScopedEnum);
-    UTEST_FUNC2(EnumConversion, CustomValues);
-    UTEST_FUNC2(EnumConversion, TypedEnum);
-    UTEST_FUNC2(EnumConversion, NegativeValues);
-    
-    // Container tests
-    UTEST_FUNC2(EnumConversion, InVector);
-    UTEST_FUNC2(EnumConversion, InVectorScoped);
-    
-    // Map tests
-    UTEST_FUNC2(EnumConversion, MapWithEnumKeys);
-    UTEST_FUNC2(EnumConversion, MapWithScopedEnumKeys);
-    
-    // Pair and tuple tests
-    UTEST_FUNC2(EnumConversion, InPair);
-    UTEST_FUNC2(EnumConversion, InTuple);
-    
-    // Mixed tests
-    UTEST_FUNC2(EnumConversion, MixedContainers);
-    
+    UTEST_RUN_REGISTERED();
     UTEST_EPILOG();
 }
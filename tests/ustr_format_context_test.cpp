@@ -3,6 +3,9 @@
 #include <vector>
 #include <sstream>
 #include <map>
+#include <tuple>
+#include <array>
+#include <memory>
 #include <iomanip>  // for std::setprecision
 
 // Test format context functionality
@@ -126,17 +129,294 @@ UTEST_FUNC_DEF2(FormatContext, ClearFormatters) {
     UTEST_ASSERT_STR_EQUALS(ctx.to_string(42), "42");
 }
 
-int main() {
-    UTEST_PROLOG();
-    UTEST_ENABLE_VERBOSE_MODE();
+UTEST_FUNC_DEF2(FormatContext, RangeFormat) {
+    ustr::format_context ctx;
+    std::vector<int> values = {1, 2, 3};
+    
+    UTEST_ASSERT_STR_EQUALS(ctx.to_string(values), "[1, 2, 3]");
+    
+    ctx.set_range_format(ustr::range_format(",", "", ""));
+    UTEST_ASSERT_STR_EQUALS(ctx.to_string(values), "1,2,3");
+    
+    // Map format is independent from sequence format
+    std::map<std::string, int> counts = {{"a", 1}};
+    UTEST_ASSERT_STR_EQUALS(ctx.to_string(counts), "{\"a\": 1}");
     
-    // Format context tests
-    UTEST_FUNC2(FormatContext, BasicUsage);
-    UTEST_FUNC2(FormatContext, CustomBoolFormatter);
-    UTEST_FUNC2(FormatContext, CustomFloatFormatter);
-    UTEST_FUNC2(FormatContext, MultipleFormatters);
-    UTEST_FUNC2(FormatContext, RemoveFormatter);
-    UTEST_FUNC2(FormatContext, ClearFormatters);
+    ctx.set_map_format(ustr::range_format(" ", "", "", "=", false));
+    std::map<std::string, int> more = {{"a", 1}, {"b", 2}};
+    UTEST_ASSERT_STR_EQUALS(ctx.to_string(more), "a=1 b=2");
+    
+    ctx.clear();
+    UTEST_ASSERT_STR_EQUALS(ctx.to_string(values), "[1, 2, 3]");
+}
+
+UTEST_FUNC_DEF2(FormatContext, RangeFormatDoesNotOverrideFormatter) {
+    ustr::format_context ctx;
+    ctx.set_range_format(ustr::range_format(";", "<", ">"));
+    ctx.set_formatter<std::vector<int>>([](const std::vector<int>& v) { return "size=" + std::to_string(v.size()); });
     
+    std::vector<int> values = {1, 2};
+    std::vector<long> others = {3, 4};
+    UTEST_ASSERT_STR_EQUALS(ctx.to_string(values), "size=2");
+    UTEST_ASSERT_STR_EQUALS(ctx.to_string(others), "<3;4>");
+    // Strings are not treated as ranges
+    UTEST_ASSERT_STR_EQUALS(ctx.to_string(std::string("abc")), "abc");
+}
+
+UTEST_FUNC_DEF2(FormatContext, NestedElements) {
+    ustr::format_context ctx;
+    ctx.set_formatter<double>([](double d) {
+        std::ostringstream ss;
+        ss << std::fixed << std::setprecision(1) << d;
+        return ss.str();
+    });
+    ctx.set_formatter<std::string>([](const std::string& s) { return "<" + s + ">"; });
+
+    std::vector<double> values = {1.26, 2.5};
+    UTEST_ASSERT_STR_EQUALS(ctx.to_string(values), "[1.3, 2.5]");
+    UTEST_ASSERT_STR_EQUALS(ctx.to_string(values.begin(), values.end()), "[1.3, 2.5]");
+
+    std::vector<std::vector<double>> nested = {{1.0}, {}, {2.0, 3.0}};
+    UTEST_ASSERT_STR_EQUALS(ctx.to_string(nested), "[[1.0], [], [2.0, 3.0]]");
+
+    std::map<std::string, std::vector<double>> series = {{"a", {0.5}}, {"b", {}}};
+    UTEST_ASSERT_STR_EQUALS(ctx.to_string(series), "{<a>: [0.5], <b>: []}");
+
+    // Formatter output is used as is, without quoting
+    std::pair<std::string, double> entry("x", 4.0);
+    UTEST_ASSERT_STR_EQUALS(ctx.to_string(entry), "(<x>, 4.0)");
+
+    std::tuple<int, double, std::string, std::vector<double>> record(7, 0.26, "id", {8.0});
+    UTEST_ASSERT_STR_EQUALS(ctx.to_string(record), "(7, 0.3, <id>, [8.0])");
+    UTEST_ASSERT_STR_EQUALS(ctx.to_string(std::tuple<>()), "()");
+}
+
+UTEST_FUNC_DEF2(FormatContext, ConstAndReferenceMembers) {
+    ustr::format_context ctx;
+    ctx.set_formatter<int>([](int i) { return "I" + std::to_string(i); });
+
+    // Members are matched by their decayed type
+    std::vector<std::tuple<const int, int>> rows = {std::tuple<const int, int>(1, 2)};
+    UTEST_ASSERT_STR_EQUALS(ctx.to_string(rows), "[(I1, I2)]");
+
+    int a = 3;
+    int b = 4;
+    UTEST_ASSERT_STR_EQUALS(ctx.to_string(std::tie(a, b)), "(I3, I4)");
+    UTEST_ASSERT_STR_EQUALS(ctx.to_string(std::forward_as_tuple(a, 5)), "(I3, I5)");
+
+    std::pair<const int, int&> entry(6, a);
+    UTEST_ASSERT_STR_EQUALS(ctx.to_string(entry), "(I6, I3)");
+    std::tuple<const std::tuple<int>, std::pair<const int, int>> nested(std::make_tuple(7), std::make_pair(8, 9));
+    UTEST_ASSERT_STR_EQUALS(ctx.to_string(nested), "((I7), (I8, I9))");
+}
+
+UTEST_FUNC_DEF2(FormatContext, NestedElementsMatchDefaults) {
+    ustr::format_context ctx;
+    ctx.set_formatter<bool>([](bool b) { return b ? "yes" : "no"; });
+
+    // Types without a formatter are formatted exactly like ustr::to_string
+    std::vector<std::vector<int>> nested = {{1, 2}, {3}};
+    std::map<std::string, std::pair<int, std::string>> table = {{"k", {1, "v"}}};
+    std::tuple<std::string, char, std::vector<std::string>> record("a", 'b', {"c"});
+    UTEST_ASSERT_STR_EQUALS(ctx.to_string(nested), ustr::to_string(nested));
+    UTEST_ASSERT_STR_EQUALS(ctx.to_string(table), ustr::to_string(table));
+    UTEST_ASSERT_STR_EQUALS(ctx.to_string(record), ustr::to_string(record));
+
+    std::vector<std::pair<int, bool>> flags = {{1, true}, {2, false}};
+    UTEST_ASSERT_STR_EQUALS(ctx.to_string(flags), "{1: yes, 2: no}");
+
+    // Range formats apply to nested containers as well
+    ctx.set_range_format(ustr::range_format(";", "<", ">"));
+    UTEST_ASSERT_STR_EQUALS(ctx.to_string(nested), "<<1;2>;<3>>");
+}
+
+UTEST_FUNC_DEF2(FormatContext, ChildFallsBackToParent) {
+    auto global = std::make_shared<ustr::format_context>();
+    global->set_formatter<bool>([](bool b) { return b ? "YES" : "NO"; });
+    global->set_formatter<std::string>([](const std::string& s) { return "'" + s + "'"; });
+    global->set_map_format(ustr::range_format(" ", "", "", "="));
+
+    ustr::format_context request(global);
+    request.set_formatter<std::string>([](const std::string&) { return std::string("***"); });
+
+    std::map<std::string, bool> flags = {{"a", true}, {"b", false}};
+    UTEST_ASSERT_STR_EQUALS(request.to_string(flags), "***=YES ***=NO");
+    UTEST_ASSERT_STR_EQUALS(global->to_string(flags), "'a'=YES 'b'=NO");
+    UTEST_ASSERT_TRUE(request.has_formatter<bool>());
+    UTEST_ASSERT_TRUE(request.parent() == global);
+
+    // Removing the override restores the parent's formatter
+    request.remove_formatter<std::string>();
+    UTEST_ASSERT_STR_EQUALS(request.to_string(std::string("x")), "'x'");
+
+    // Clearing drops overrides only
+    request.set_formatter<bool>([](bool) { return std::string("?"); });
+    request.set_range_format(ustr::range_format(",", "", ""));
+    request.clear();
+    UTEST_ASSERT_STR_EQUALS(request.to_string(true), "YES");
+    UTEST_ASSERT_STR_EQUALS(request.to_string(flags), "'a'=YES 'b'=NO");
+}
+
+UTEST_FUNC_DEF2(FormatContext, ChildChain) {
+    auto root = std::make_shared<ustr::format_context>();
+    root->set_formatter<int>([](int i) { return "#" + std::to_string(i); });
+    auto tenant = std::make_shared<ustr::format_context>(root);
+    tenant->set_formatter<bool>([](bool b) { return b ? "on" : "off"; });
+    ustr::format_context request(tenant);
+    request.set_formatter<int>([](int) { return std::string("n"); });
+
+    auto record = std::make_tuple(1, true);
+    UTEST_ASSERT_STR_EQUALS(request.to_string(record), "(n, on)");
+    UTEST_ASSERT_STR_EQUALS(tenant->to_string(record), "(#1, on)");
+    UTEST_ASSERT_STR_EQUALS(root->to_string(record), "(#1, true)");
+
+    // Removing a formatter the child never set keeps the inherited one
+    request.remove_formatter<bool>();
+    UTEST_ASSERT_STR_EQUALS(request.to_string(false), "off");
+    request.remove_formatter<int>();
+    UTEST_ASSERT_STR_EQUALS(request.to_string(2), "#2");
+
+    ustr::format_context detached(nullptr);
+    UTEST_ASSERT_FALSE(detached.has_formatter<int>());
+    UTEST_ASSERT_STR_EQUALS(detached.to_string(2), "2");
+}
+
+class HexFormatter : public ustr::buffer_formatter_base<int> {
+public:
+    void format_to(const int& value, std::string& out) const override {
+        std::ostringstream ss;
+        ss << "0x" << std::hex << value;
+        out += ss.str();
+    }
+};
+
+UTEST_FUNC_DEF2(FormatContext, BufferFormatters) {
+    ustr::format_context ctx;
+    ctx.set_formatter<bool>([](bool b, std::string& out) { out += b ? "YES" : "NO"; });
+    ctx.set_formatter<int>(std::make_shared<HexFormatter>());
+
+    std::vector<std::pair<int, bool>> flags = {{10, true}, {255, false}};
+    UTEST_ASSERT_STR_EQUALS(ctx.to_string(flags), "{0xa: YES, 0xff: NO}");
+    UTEST_ASSERT_STR_EQUALS(ctx.to_string(true), "YES");
+    UTEST_ASSERT_STR_EQUALS(ctx.to_string(42), "0x2a");
+
+    // Both interfaces are available on every formatter
+    HexFormatter hex;
+    UTEST_ASSERT_STR_EQUALS(hex.format(16), "0x10");
+    ustr::lambda_formatter<int, std::string (*)(int)> plain([](int i) { return std::to_string(i); });
+    std::string out = "n=";
+    plain.format_to(3, out);
+    UTEST_ASSERT_STR_EQUALS(out, "n=3");
+
+    // append_to writes into an existing message
+    std::string line = "flags=";
+    ctx.append_to(line, flags).append(";");
+    UTEST_ASSERT_STR_EQUALS(line, "flags={0xa: YES, 0xff: NO};");
+    ustr::format_context empty;
+    empty.append_to(line, 7);
+    UTEST_ASSERT_STR_EQUALS(line, "flags={0xa: YES, 0xff: NO};7");
+}
+
+// Formatter function that can be moved but not copied
+struct MoveOnlyPrefix {
+    std::unique_ptr<std::string> prefix;
+    explicit MoveOnlyPrefix(const std::string& p) : prefix(new std::string(p)) {}
+    std::string operator()(long i) const { return *prefix + std::to_string(i); }
+};
+
+UTEST_FUNC_DEF2(FormatContext, FormatterStorage) {
+    auto small = [](int i) { return std::to_string(i); };
+    std::array<char, 64> padding = {{'!'}};
+    auto large = [padding](int i) { return padding[0] + std::to_string(i); };
+
+    auto inline_storage = ustr::details::formatter_storage::create<int>(ustr::lambda_formatter<int, decltype(small)>(small));
+    auto heap_storage = ustr::details::formatter_storage::create<int>(ustr::lambda_formatter<int, decltype(large)>(large));
+    UTEST_ASSERT_TRUE(inline_storage.is_inline());
+    UTEST_ASSERT_FALSE(heap_storage.is_inline());
+    auto moved = std::move(inline_storage);
+    UTEST_ASSERT_TRUE(moved.is_inline());
+    UTEST_ASSERT_NULL(inline_storage.get());
+    UTEST_ASSERT_STR_EQUALS(static_cast<const ustr::formatter_base<int>*>(moved.get())->format(5), "5");
+    UTEST_ASSERT_STR_EQUALS(static_cast<const ustr::formatter_base<int>*>(heap_storage.get())->format(5), "!5");
+
+    ustr::format_context ctx;
+    ctx.set_formatter<int>(large);
+    ctx.set_formatter<long>(MoveOnlyPrefix("L"));
+    ctx.set_formatter<bool>([](bool b) { return b ? "Y" : "N"; });
+    UTEST_ASSERT_STR_EQUALS(ctx.to_string(std::make_tuple(1, 2L, true)), "(!1, L2, Y)");
+}
+
+UTEST_FUNC_DEF2(FormatContext, CopiesAreIndependent) {
+    std::unique_ptr<ustr::format_context> original(new ustr::format_context());
+    original->set_formatter<bool>([](bool b) { return b ? "yes" : "no"; });
+    original->set_formatter<char>([](char c) { return std::string(2, c); });
+
+    ustr::format_context copy(*original);
+    ustr::format_context assigned;
+    assigned = *original;
+    original->set_formatter<bool>([](bool) { return std::string("changed"); });
+    original->remove_formatter<char>();
+    UTEST_ASSERT_STR_EQUALS(original->to_string(std::make_pair(true, 'x')), "(changed, x)");
+    original.reset();
+
+    // Copies keep their own formatters after the original is gone
+    UTEST_ASSERT_STR_EQUALS(copy.to_string(std::make_pair(true, 'x')), "(yes, xx)");
+    UTEST_ASSERT_STR_EQUALS(assigned.to_string(std::make_pair(false, 'y')), "(no, yy)");
+    ustr::format_context moved(std::move(copy));
+    UTEST_ASSERT_STR_EQUALS(moved.to_string(true), "yes");
+}
+
+UTEST_FUNC_DEF2(FormatContext, CopyOnWrite) {
+    ustr::format_context base;
+    base.set_formatter<bool>([](bool b) { return b ? "yes" : "no"; });
+
+    ustr::format_context copy = base;
+    copy.set_formatter<int>([](int i) { return "#" + std::to_string(i); });
+    copy.set_range_format(ustr::range_format("|", "", ""));
+    base.remove_formatter<bool>();
+
+    std::vector<int> ids = {1, 2};
+    UTEST_ASSERT_STR_EQUALS(copy.to_string(true), "yes");
+    UTEST_ASSERT_STR_EQUALS(copy.to_string(ids), "#1|#2");
+    UTEST_ASSERT_STR_EQUALS(base.to_string(true), "true");
+    UTEST_ASSERT_STR_EQUALS(base.to_string(ids), "[1, 2]");
+
+    // Remaining formatters keep working when one from the middle is removed
+    ustr::format_context trimmed = copy;
+    trimmed.set_formatter<char>([](char c) { return std::string(3, c); });
+    trimmed.remove_formatter<bool>();
+    UTEST_ASSERT_STR_EQUALS(trimmed.to_string(std::make_tuple(true, 5, 'z')), "(true, #5, zzz)");
+    UTEST_ASSERT_STR_EQUALS(copy.to_string(std::make_tuple(true, 5, 'z')), "(yes, #5, z)");
+
+    // Removing a formatter that is not set leaves the shared table alone
+    ustr::format_context other = copy;
+    other.remove_formatter<double>();
+    other.clear();
+    UTEST_ASSERT_STR_EQUALS(copy.to_string(ids), "#1|#2");
+    UTEST_ASSERT_STR_EQUALS(other.to_string(ids), "[1, 2]");
+}
+
+UTEST_FUNC_DEF2(FormatContext, ChildKeepsParentSnapshot) {
+    auto global = std::make_shared<ustr::format_context>();
+    global->set_formatter<int>([](int i) { return "#" + std::to_string(i); });
+    ustr::format_context request(global);
+    ustr::format_context tenant(global);
+    tenant.set_formatter<bool>([](bool b) { return b ? "on" : "off"; });
+
+    // Changing the parent does not affect existing children
+    global->remove_formatter<int>();
+    global->set_formatter<bool>([](bool) { return std::string("?"); });
+    UTEST_ASSERT_STR_EQUALS(request.to_string(std::make_pair(1, true)), "(#1, true)");
+    UTEST_ASSERT_STR_EQUALS(tenant.to_string(std::make_pair(1, true)), "(#1, on)");
+    UTEST_ASSERT_STR_EQUALS(global->to_string(std::make_pair(1, true)), "(1, ?)");
+
+    tenant.clear();
+    UTEST_ASSERT_STR_EQUALS(tenant.to_string(std::make_pair(2, false)), "(#2, false)");
+}
+
+int main(int argc, char* argv[]) {
+    UTEST_PROLOG(argc, argv);
+    UTEST_ENABLE_VERBOSE_MODE();
+    UTEST_RUN_REGISTERED();
     UTEST_EPILOG();
 }
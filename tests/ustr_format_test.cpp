@@ -0,0 +1,226 @@
+#include "../include/ustr/ustr.h"
+#include "../include/utest/utest.h"
+#include <vector>
+#include <string>
+#include <limits>
+#include <map>
+#include <tuple>
+
+// Helper class with custom to_string method
+class FormatPoint {
+    int x_, y_;
+public:
+    FormatPoint(int x, int y) : x_(x), y_(y) {}
+    std::string to_string() const {
+        return "(" + std::to_string(x_) + "," + std::to_string(y_) + ")";
+    }
+};
+
+// Aggregate registered for field-by-field conversion
+struct LogEvent {
+    std::string user;
+    int status;
+    std::string message;
+};
+USTR_REFLECT(LogEvent, user, status, message)
+
+// Test append_to matches to_string for all fast-path types
+UTEST_FUNC_DEF2(AppendTo, NumericTypes) {
+    std::string out;
+    ustr::append_to(out, 42);
+    UTEST_ASSERT_STR_EQUALS(out, "42");
+
+    out.clear();
+    ustr::append_to(out, -17L);
+    UTEST_ASSERT_STR_EQUALS(out, "-17");
+
+    out.clear();
+    ustr::append_to(out, 3.14);
+    UTEST_ASSERT_STR_EQUALS(out, ustr::to_string(3.14));
+
+    out.clear();
+    ustr::append_to(out, 2.5f);
+    UTEST_ASSERT_STR_EQUALS(out, "2.500000");
+}
+
+UTEST_FUNC_DEF2(AppendTo, IntegerLimits) {
+    std::string out;
+    ustr::append_to(out, std::numeric_limits<int>::min());
+    UTEST_ASSERT_STR_EQUALS(out, std::to_string(std::numeric_limits<int>::min()));
+
+    out.clear();
+    ustr::append_to(out, std::numeric_limits<long long>::min());
+    UTEST_ASSERT_STR_EQUALS(out, std::to_string(std::numeric_limits<long long>::min()));
+
+    out.clear();
+    ustr::append_to(out, std::numeric_limits<unsigned long long>::max());
+    UTEST_ASSERT_STR_EQUALS(out, std::to_string(std::numeric_limits<unsigned long long>::max()));
+
+    out.clear();
+    ustr::append_to(out, 0u);
+    UTEST_ASSERT_STR_EQUALS(out, "0");
+
+    for (int i = -1000; i <= 1000; i += 7) {
+        out.clear();
+        ustr::append_to(out, i);
+        UTEST_ASSERT_STR_EQUALS(out, std::to_string(i));
+    }
+}
+
+UTEST_FUNC_DEF2(AppendTo, SpecialTypes) {
+    std::string out = "prefix:";
+    ustr::append_to(out, true);
+    ustr::append_to(out, 'x');
+    ustr::append_to(out, "lit");
+    ustr::append_to(out, std::string("str"));
+    ustr::append_to(out, nullptr);
+    UTEST_ASSERT_STR_EQUALS(out, "prefix:truexlitstrnull");
+
+    const char* null_str = nullptr;
+    out.clear();
+    ustr::append_to(out, null_str);
+    UTEST_ASSERT_STR_EQUALS(out, "null");
+}
+
+UTEST_FUNC_DEF2(AppendTo, DelegatesToDispatch) {
+    std::string out;
+    ustr::append_to(out, FormatPoint(1, 2));
+    ustr::append_to(out, std::vector<int>{1, 2});
+    UTEST_ASSERT_STR_EQUALS(out, "(1,2)[1, 2]");
+}
+
+// Test USTR_FORMAT macro (available in all standards)
+UTEST_FUNC_DEF2(FormatMacro, BasicPlaceholders) {
+    UTEST_ASSERT_STR_EQUALS(USTR_FORMAT("{} -> {}", 1, "one"), "1 -> one");
+    UTEST_ASSERT_STR_EQUALS(USTR_FORMAT("{}{}{}", 'a', 'b', 'c'), "abc");
+    UTEST_ASSERT_STR_EQUALS(USTR_FORMAT("value: {}", true), "value: true");
+}
+
+UTEST_FUNC_DEF2(FormatMacro, NoArguments) {
+    UTEST_ASSERT_STR_EQUALS(USTR_FORMAT("plain text"), "plain text");
+    UTEST_ASSERT_STR_EQUALS(USTR_FORMAT(""), "");
+}
+
+UTEST_FUNC_DEF2(FormatMacro, EscapedBraces) {
+    UTEST_ASSERT_STR_EQUALS(USTR_FORMAT("{{}}"), "{}");
+    UTEST_ASSERT_STR_EQUALS(USTR_FORMAT("{{{}}}", 42), "{42}");
+    UTEST_ASSERT_STR_EQUALS(USTR_FORMAT("set {{{}, {}}}", 1, 2), "set {1, 2}");
+}
+
+UTEST_FUNC_DEF2(FormatMacro, MixedTypes) {
+    std::vector<int> values = {1, 2, 3};
+    std::string result = USTR_FORMAT("{} has {} at {}", values, values.size(), FormatPoint(3, 4));
+    UTEST_ASSERT_STR_EQUALS(result, "[1, 2, 3] has 3 at (3,4)");
+    UTEST_ASSERT_STR_EQUALS(USTR_FORMAT("pi={}", 3.14159), "pi=3.141590");
+}
+
+UTEST_FUNC_DEF2(FormatMacro, CompileTimeCount) {
+    static_assert(ustr::details::count_format_placeholders("{} {}") == 2, "two placeholders");
+    static_assert(ustr::details::count_format_placeholders("{{}} {}") == 1, "escaped braces are not placeholders");
+    static_assert(ustr::details::count_format_placeholders("{x}") == ustr::details::FORMAT_STRING_INVALID, "invalid placeholder");
+    static_assert(ustr::details::count_format_placeholders("}") == ustr::details::FORMAT_STRING_INVALID, "lone closing brace");
+    UTEST_ASSERT_TRUE(true);
+}
+
+// Test logfmt output
+UTEST_FUNC_DEF2(Logfmt, MapFields) {
+    std::map<std::string, std::string> labels = {{"env", "prod"}, {"job", "api"}};
+    UTEST_ASSERT_STR_EQUALS(ustr::to_logfmt(labels), "env=prod job=api");
+
+    std::vector<std::pair<std::string, int>> counts = {{"a", 1}, {"b", -2}};
+    UTEST_ASSERT_STR_EQUALS(ustr::to_logfmt(counts), "a=1 b=-2");
+}
+
+UTEST_FUNC_DEF2(Logfmt, TupleOfPairs) {
+    auto fields = std::make_tuple(std::make_pair("user", 42),
+                                  std::make_pair("ok", true),
+                                  std::make_pair("msg", "logged in"));
+    UTEST_ASSERT_STR_EQUALS(ustr::to_logfmt(fields), "user=42 ok=true msg=\"logged in\"");
+}
+
+UTEST_FUNC_DEF2(Logfmt, QuotingOnlyWhenNeeded) {
+    std::vector<std::pair<std::string, std::string>> fields = {
+        {"plain", "value"},
+        {"empty", ""},
+        {"eq", "a=b"},
+        {"quote", "say \"hi\""},
+        {"path", "C:\\tmp"},
+        {"multi", "line1\nline2"}
+    };
+    UTEST_ASSERT_STR_EQUALS(ustr::to_logfmt(fields),
+        "plain=value empty=\"\" eq=\"a=b\" quote=\"say \\\"hi\\\"\" path=C:\\tmp multi=\"line1\\nline2\"");
+}
+
+UTEST_FUNC_DEF2(Logfmt, EscapesControlCharacters) {
+    std::vector<std::pair<std::string, std::string>> fields = {
+        {"esc", "\x1b[31mred"},
+        {"nul", std::string("a\0b", 3)},
+        {"soh", "\x01"},
+        {"del", "x\x7f"},
+        {"utf8", "caf\xc3\xa9"}
+    };
+    UTEST_ASSERT_STR_EQUALS(ustr::to_logfmt(fields),
+        "esc=\"\\x1b[31mred\" nul=\"a\\x00b\" soh=\"\\x01\" del=\"x\\x7f\" utf8=caf\xc3\xa9");
+}
+
+UTEST_FUNC_DEF2(Logfmt, NonStringValuesAndKeys) {
+    std::vector<int> values = {1, 2};
+    auto fields = std::make_tuple(std::make_pair("list", values),
+                                  std::make_pair("bad key", 1),
+                                  std::make_pair(7, 'x'));
+    UTEST_ASSERT_STR_EQUALS(ustr::to_logfmt(fields), "list=\"[1, 2]\" bad_key=1 7=x");
+}
+
+UTEST_FUNC_DEF2(Logfmt, ReflectedStruct) {
+    LogEvent event = {"bob", 404, "not found"};
+    UTEST_ASSERT_STR_EQUALS(ustr::to_logfmt(event), "user=bob status=404 message=\"not found\"");
+
+    auto line = std::make_tuple(std::make_pair("level", "warn"), event);
+    UTEST_ASSERT_STR_EQUALS(ustr::to_logfmt(line), "level=warn user=bob status=404 message=\"not found\"");
+}
+
+UTEST_FUNC_DEF2(Logfmt, AppendToLine) {
+    std::string line = "level=info";
+    std::map<std::string, int> extra = {{"code", 200}};
+    ustr::append_logfmt(line, extra);
+    ustr::append_logfmt(line, std::make_pair("msg", "done"));
+    UTEST_ASSERT_STR_EQUALS(line, "level=info code=200 msg=done");
+}
+
+#if __cplusplus >= 202002L && defined(__cpp_consteval)
+// Test ustr::format (C++20 consteval checked format strings)
+UTEST_FUNC_DEF2(Format, BasicPlaceholders) {
+    UTEST_ASSERT_STR_EQUALS(ustr::format("{} -> {}", 1, "one"), "1 -> one");
+    UTEST_ASSERT_STR_EQUALS(ustr::format("no placeholders"), "no placeholders");
+    UTEST_ASSERT_STR_EQUALS(ustr::format("{{{}}}", 42), "{42}");
+}
+
+namespace user_format {
+struct Tag {
+    std::string to_string() const { return "tag"; }
+};
+
+// Found by argument-dependent lookup and, as a non-template, preferred over
+// ustr::format_to by an unqualified call; ustr::format must not pick it
+inline std::string& format_to(std::string& out, ustr::format_string<Tag>, const Tag&) {
+    return out += "user_format::format_to";
+}
+}
+
+UTEST_FUNC_DEF2(Format, IgnoresFormatToOfArgumentNamespaces) {
+    UTEST_ASSERT_STR_EQUALS(ustr::format("<{}>", user_format::Tag()), "<tag>");
+}
+
+UTEST_FUNC_DEF2(Format, FormatTo) {
+    std::string out = "log: ";
+    ustr::format_to(out, "{}={}", "key", 7);
+    UTEST_ASSERT_STR_EQUALS(out, "log: key=7");
+}
+#endif
+
+int main(int argc, char* argv[]) {
+    UTEST_PROLOG(argc, argv);
+    UTEST_ENABLE_VERBOSE_MODE();
+    UTEST_RUN_REGISTERED();
+    UTEST_EPILOG();
+}
@@ -92,24 +92,9 @@ UTEST_FUNC_DEF2(PairFormatComparison, DirectVsIterator) {
     UTEST_ASSERT_STR_EQUALS(iterator_result, "{\"key\": 42}");
 }
 
-int main() {
-    UTEST_PROLOG();
+int main(int argc, char* argv[]) {
+    UTEST_PROLOG(argc, argv);
     UTEST_ENABLE_VERBOSE_MODE();
-    
-    // Iterator conversion tests with pairs
-    UTEST_FUNC2(IteratorConversion, PairContainer);
-    
-    // std::pair specialization tests
-    UTEST_FUNC2(PairSpecialization, IntStringPair);
-    UTEST_FUNC2(PairSpecialization, DoubleBoolPair);
-    UTEST_FUNC2(PairSpecialization, NestedPair);
-    UTEST_FUNC2(PairSpecialization, StringStringPair);
-    UTEST_FUNC2(PairSpecialization, PairWithContainer);
-    UTEST_FUNC2(PairSpecialization, MixedTypePair);
-    UTEST_FUNC2(PairSpecialization, QuotationComprehensiveTest);
-    
-    // Format comparison tests
-    UTEST_FUNC2(PairFormatComparison, DirectVsIterator);
-    
+    UTEST_RUN_REGISTERED();
     UTEST_EPILOG();
 }
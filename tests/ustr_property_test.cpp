@@ -0,0 +1,168 @@
+#include "../include/ustr/ustr.h"
+#include "../include/utest/utest.h"
+#include "../include/utest/utest_prop.h"
+#include <vector>
+#include <string>
+#include <map>
+#include <tuple>
+
+// quoted_str drops a leading UTF-8 BOM, so round-trips compare against the input without it
+static std::string withoutBom(const std::string& s) {
+    if (s.size() >= 3 && s.compare(0, 3, "\xEF\xBB\xBF") == 0) {
+        return s.substr(3);
+    }
+    return s;
+}
+
+// Scans container output: brackets outside quoted strings must be balanced, and
+// every quoted string must unquote cleanly. Collects the unquoted strings in order.
+static bool scanContainerOutput(const std::string& text, std::vector<std::string>& strings, std::string& error) {
+    std::string open;
+    for (std::size_t i = 0; i < text.size(); ++i) {
+        const char c = text[i];
+        if (c == '"') {
+            std::size_t end = i + 1;
+            while (end < text.size() && text[end] != '"') {
+                end += (text[end] == '\\') ? std::size_t(2) : std::size_t(1);
+            }
+            if (end >= text.size()) {
+                error = "unterminated string at " + std::to_string(i);
+                return false;
+            }
+            std::string value;
+            if (!ustr::unquoted_str(text.substr(i, end - i + 1), value)) {
+                error = "malformed string at " + std::to_string(i);
+                return false;
+            }
+            strings.push_back(value);
+            i = end;
+        } else if (c == '[' || c == '{' || c == '(') {
+            open += c;
+        } else if (c == ']' || c == '}' || c == ')') {
+            const char expected = (c == ']') ? '[' : (c == '}') ? '{' : '(';
+            if (open.empty() || open[open.size() - 1] != expected) {
+                error = std::string("unbalanced '") + c + "' at " + std::to_string(i);
+                return false;
+            }
+            open.erase(open.size() - 1);
+        }
+    }
+    if (!open.empty()) {
+        error = "unclosed '" + open + "'";
+        return false;
+    }
+    return true;
+}
+
+static void assertWellFormed(const std::string& text, const std::vector<std::string>& expected_strings) {
+    std::vector<std::string> strings;
+    std::string error;
+    UTEST_ASSERT_TRUE_MSG(scanContainerOutput(text, strings, error), error << " in " << text);
+    UTEST_ASSERT_EQUALS(strings.size(), expected_strings.size());
+    for (std::size_t i = 0; i < strings.size(); ++i) {
+        UTEST_ASSERT_STR_EQUALS(strings[i], withoutBom(expected_strings[i]));
+    }
+}
+
+// Test quoting round-trips
+UTEST_FUNC_DEF2(QuotedStrProperty, RoundTripDefault) {
+    utest::prop::Config config;
+    config.cases = 20000;
+    utest::prop::forAll<std::string>("quoted_str round-trip", [](const std::string& s) {
+        const std::string quoted = ustr::quoted_str(s);
+        std::string text;
+        UTEST_ASSERT_TRUE(ustr::unquoted_str(quoted, text));
+        UTEST_ASSERT_STR_EQUALS(text, withoutBom(s));
+    }, config);
+}
+
+UTEST_FUNC_DEF2(QuotedStrProperty, RoundTripCustomDelimiters) {
+    struct Quotation {
+        char start;
+        char end;
+        char escape;
+        bool is_utf8;
+    };
+    static const Quotation quotations[] = {
+        {'[', ']', '/', false},
+        {'<', '>', '\\', true},
+        {'\'', '\'', '\\', true},
+        {'"', '"', '"', false},   // CSV style, the delimiter escapes itself
+        {'{', '}', '{', false},
+    };
+    for (const Quotation& q : quotations) {
+        utest::prop::forAll<std::string>("quoted_str round-trip with custom delimiters", [&q](const std::string& s) {
+            const std::string quoted = ustr::quoted_str(s, q.start, q.end, q.escape, q.is_utf8);
+            std::string text;
+            UTEST_ASSERT_TRUE_MSG(ustr::unquoted_str(quoted, text, q.start, q.end, q.escape, q.is_utf8), quoted);
+            UTEST_ASSERT_STR_EQUALS(text, withoutBom(s));
+        });
+    }
+}
+
+UTEST_FUNC_DEF2(QuotedStrProperty, UnquoteRejectsTruncatedInput) {
+    utest::prop::forAll<std::string>("unquoted_str rejects truncated input", [](const std::string& s) {
+        const std::string quoted = ustr::quoted_str(s);
+        std::string text;
+        UTEST_ASSERT_FALSE(ustr::unquoted_str(quoted.substr(0, quoted.size() - 1), text));
+        UTEST_ASSERT_TRUE(text.empty());
+    });
+}
+
+// Test container formatting of generated nested values
+UTEST_FUNC_DEF2(ContainerProperty, NestedVectorsOfStrings) {
+    utest::prop::forAll<std::vector<std::vector<std::string> > >("nested vectors are well-formed",
+        [](const std::vector<std::vector<std::string> >& value) {
+            std::vector<std::string> flat;
+            for (const auto& inner : value) {
+                flat.insert(flat.end(), inner.begin(), inner.end());
+            }
+            assertWellFormed(ustr::to_string(value), flat);
+        });
+}
+
+UTEST_FUNC_DEF2(ContainerProperty, MapsOfVectors) {
+    utest::prop::forAll<std::map<std::string, std::vector<int> > >("maps are well-formed",
+        [](const std::map<std::string, std::vector<int> >& value) {
+            std::vector<std::string> keys;
+            for (const auto& entry : value) {
+                keys.push_back(entry.first);
+            }
+            assertWellFormed(ustr::to_string(value), keys);
+        });
+}
+
+UTEST_FUNC_DEF2(ContainerProperty, TuplesAndPairs) {
+    typedef std::tuple<int, std::string, std::vector<std::pair<std::string, double> > > Record;
+    utest::prop::forAll<Record>("tuples are well-formed", [](const Record& value) {
+        std::vector<std::string> strings(1, std::get<1>(value));
+        for (const auto& entry : std::get<2>(value)) {
+            strings.push_back(entry.first);
+        }
+        assertWellFormed(ustr::to_string(value), strings);
+    });
+}
+
+// Test the harness itself: failures are shrunk and reported with the seed
+UTEST_FUNC_DEF2(PropertyHarness, ShrinksCounterexample) {
+    std::string message;
+    try {
+        utest::prop::forAll<std::vector<int> >("no vector holds 7", [](const std::vector<int>& value) {
+            for (int element : value) {
+                UTEST_ASSERT_NOT_EQUALS(element, 7);
+            }
+        });
+    } catch (const utest::AssertionException& e) {
+        message = e.what();
+    }
+    UTEST_ASSERT_STR_CONTAINS(message, "Property 'no vector holds 7' failed after");
+    UTEST_ASSERT_STR_CONTAINS(message, "UTEST_PROP_SEED=");
+    UTEST_ASSERT_STR_CONTAINS(message, "counterexample: [7]");
+}
+
+int main(int argc, char* argv[]) {
+    UTEST_PROLOG(argc, argv);
+    UTEST_ENABLE_VERBOSE_MODE();
+    UTEST_RUN_REGISTERED();
+    UTEST_EPILOG();
+}
@@ -236,64 +236,46 @@ UTEST_FUNC_DEF2(QuotedStr, PartialBOMString) {
 }
 
 
-int main() {
-    UTEST_PROLOG();
-    
-    // Basic functionality tests
-    UTEST_FUNC2(QuotedStr, EmptyString);
-    UTEST_FUNC2(QuotedStr, SimpleString);
-    UTEST_FUNC2(QuotedStr, StringWithoutSpecialChars);
-    
-    // Delimiter escaping tests
-    UTEST_FUNC2(QuotedStr, StringWithDelimiter);
-    UTEST_FUNC2(QuotedStr, StringWithMultipleDelimiters);
-    
-    // Escape character tests
-    UTEST_FUNC2(QuotedStr, StringWithEscapeChar);
-    UTEST_FUNC2(QuotedStr, StringWithMultipleEscapeChars);
-    
-    // Mixed escaping tests
-    UTEST_FUNC2(QuotedStr, StringWithBothDelimAndEscape);
-    
-    // Custom delimiters and escape chars
-    UTEST_FUNC2(QuotedStr, CustomDelimiter);
-    UTEST_FUNC2(QuotedStr, CustomDelimiterWithEscaping);
-    UTEST_FUNC2(QuotedStr, CustomEscapeChar);
-    UTEST_FUNC2(QuotedStr, NoEscapeMode);
-    
-    // UTF-8 tests
-    UTEST_FUNC2(QuotedStr, UTF8Characters);
-    UTEST_FUNC2(QuotedStr, UTF8WithDelimiters);
-    
-    // Edge cases
-    UTEST_FUNC2(QuotedStr, OnlyDelimiters);
-    UTEST_FUNC2(QuotedStr, OnlyEscapeChars);
-    UTEST_FUNC2(QuotedStr, SingleDelimiter);
-    UTEST_FUNC2(QuotedStr, SingleEscapeChar);
-    
-    // Performance test
-    UTEST_FUNC2(QuotedStr, LargeString);
-    
-    // Combination tests
-    UTEST_FUNC2(QuotedStr, DifferentCombinations);
-    
-    // Start/End delimiter tests
-    UTEST_FUNC2(QuotedStr, DifferentStartEndDelimiters);
-    UTEST_FUNC2(QuotedStr, StartEndDelimitersWithEscaping);
-    UTEST_FUNC2(QuotedStr, StartEndDelimitersComplex);
-    
-    // is_utf8 parameter tests
-    UTEST_FUNC2(QuotedStr, UTF8Enabled);
-    // UTEST_FUNC2(QuotedStr, UTF8Disabled); // Commented out as per user request
-    UTEST_FUNC2(QuotedStr, UTF8DisabledWithEscaping);
-    
-    // BOM handling tests
-    UTEST_FUNC2(QuotedStr, BOMSkipping);
-    UTEST_FUNC2(QuotedStr, BOMSkippingWithEscaping);
-    UTEST_FUNC2(QuotedStr, BOMSkippingASCIIMode);
-    UTEST_FUNC2(QuotedStr, BOMSkippingNoEscape);
-    UTEST_FUNC2(QuotedStr, NoBOMString);
-    UTEST_FUNC2(QuotedStr, PartialBOMString);
-    
+UTEST_FUNC_DEF2(QuotedStr, UTF8TruncatedSequenceBeforeDelimiter) {
+    // A lead byte without continuation bytes must not swallow the following delimiter
+    std::string truncated = "a\xE0\"b";
+    std::string result = ustr::quoted_str(truncated, '"', '"', '\\', true);
+    UTEST_ASSERT_STR_EQUALS(result, "\"a\xE0\\\"b\"");
+}
+
+// Tests for unquoted_str
+UTEST_FUNC_DEF2(UnquotedStr, Basic) {
+    std::string text;
+    UTEST_ASSERT_TRUE(ustr::unquoted_str("\"say \\\"hi\\\"\"", text));
+    UTEST_ASSERT_STR_EQUALS(text, "say \"hi\"");
+    UTEST_ASSERT_TRUE(ustr::unquoted_str("\"\"", text));
+    UTEST_ASSERT_STR_EQUALS(text, "");
+    UTEST_ASSERT_TRUE(ustr::unquoted_str("[a/]b//]", text, '[', ']', '/'));
+    UTEST_ASSERT_STR_EQUALS(text, "a]b/");
+    UTEST_ASSERT_TRUE(ustr::unquoted_str("<a>b>", text, '<', '>', '\0'));
+    UTEST_ASSERT_STR_EQUALS(text, "a>b");
+}
+
+UTEST_FUNC_DEF2(UnquotedStr, MalformedInput) {
+    std::string text = "previous";
+    UTEST_ASSERT_FALSE(ustr::unquoted_str("", text));
+    UTEST_ASSERT_TRUE(text.empty());
+    UTEST_ASSERT_FALSE(ustr::unquoted_str("\"open", text));
+    UTEST_ASSERT_FALSE(ustr::unquoted_str("no quotes", text));
+    UTEST_ASSERT_FALSE(ustr::unquoted_str("\"a\"b\"", text));
+    UTEST_ASSERT_FALSE(ustr::unquoted_str("\"dangling\\\"", text));
+    UTEST_ASSERT_FALSE(ustr::unquoted_str("[a[b]", text, '[', ']', '/'));
+    UTEST_ASSERT_TRUE(text.empty());
+}
+
+UTEST_FUNC_DEF2(UnquotedStr, RoundTripWithBOM) {
+    std::string text;
+    UTEST_ASSERT_TRUE(ustr::unquoted_str(ustr::quoted_str("\xEF\xBB\xBF" "x \"y\""), text));
+    UTEST_ASSERT_STR_EQUALS(text, "x \"y\"");
+}
+
+int main(int argc, char* argv[]) {
+    UTEST_PROLOG(argc, argv);
+    UTEST_RUN_REGISTERED();
     UTEST_EPILOG();
 }
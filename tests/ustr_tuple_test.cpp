@@ -116,24 +116,9 @@ UTEST_FUNC_DEF2(TypeTraits, IsTuple) {
     UTEST_ASSERT_FALSE(ustr::is_tuple<bool>::value);
 }
 
-int main() {
-    UTEST_PROLOG();
+int main(int argc, char* argv[]) {
+    UTEST_PROLOG(argc, argv);
     UTEST_ENABLE_VERBOSE_MODE();
-    
-    // Tuple specialization tests
-    UTEST_FUNC2(TupleSpecialization, EmptyTuple);
-    UTEST_FUNC2(TupleSpecialization, SingleElementTuple);
-    UTEST_FUNC2(TupleSpecialization, TwoElementTuple);
-    UTEST_FUNC2(TupleSpecialization, ThreeElementTuple);
-    UTEST_FUNC2(TupleSpecialization, BoolCharIntTuple);
-    UTEST_FUNC2(TupleSpecialization, NestedTuple);
-    UTEST_FUNC2(TupleSpecialization, TupleWithVector);
-    UTEST_FUNC2(TupleSpecialization, TupleWithPair);
-    UTEST_FUNC2(TupleSpecialization, LargeTuple);
-    UTEST_FUNC2(TupleSpecialization, QuotationComprehensiveTest);
-    
-    // Type trait tests
-    UTEST_FUNC2(TypeTraits, IsTuple);
-    
+    UTEST_RUN_REGISTERED();
     UTEST_EPILOG();
 }
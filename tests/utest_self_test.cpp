@@ -0,0 +1,219 @@
+#include "../include/ustr/ustr.h"
+#include "../include/utest/utest.h"
+#include <vector>
+#include <string>
+#include <tuple>
+#include <list>
+#include <cstdlib>
+
+// Test utest messages use ustr conversions when UTEST_USE_USTR is defined
+UTEST_FUNC_DEF2(UtestIntegration, ConvertToString) {
+    std::vector<int> values = {1, 2};
+    UTEST_ASSERT_STR_EQUALS(UTEST_TO_STRING(values), "[1, 2]");
+    UTEST_ASSERT_STR_EQUALS(UTEST_TO_STRING(std::make_tuple(1, "a")), "(1, \"a\")");
+    const char* null_str = nullptr;
+    UTEST_ASSERT_STR_EQUALS(UTEST_TO_STRING(null_str), "null");
+    UTEST_ASSERT_STR_EQUALS(UTEST_TO_STRING(42), "42");
+}
+
+UTEST_FUNC_DEF2(UtestIntegration, AssertionMessageShowsContainers) {
+    std::vector<int> actual = {1, 2, 3};
+    std::vector<int> expected = {1, 2, 4};
+    std::string message;
+    try {
+        UTEST_ASSERT_EQUALS(actual, expected);
+    } catch (const utest::AssertionException& e) {
+        message = e.what();
+    }
+    UTEST_ASSERT_STR_EQUALS(message, "Assertion failed: [1, 2, 3] != [1, 2, 4]");
+}
+
+// String assertions compare without allocating and only format messages on failure
+UTEST_FUNC_DEF2(UtestIntegration, StringAssertionsWithoutCopies) {
+    std::string text = "alpha beta";
+    const char* null_str = nullptr;
+    UTEST_ASSERT_TRUE(utest::details::str_equals(text, "alpha beta"));
+    UTEST_ASSERT_TRUE(utest::details::str_equals(null_str, ""));
+    UTEST_ASSERT_FALSE(utest::details::str_equals(text, "alpha"));
+    UTEST_ASSERT_TRUE(utest::details::str_contains(text, "a b"));
+    UTEST_ASSERT_TRUE(utest::details::str_contains(text, ""));
+    UTEST_ASSERT_FALSE(utest::details::str_contains("alpha", text));
+    UTEST_ASSERT_TRUE(utest::details::str_contains(std::wstring(L"wide text"), L"text"));
+#if __cplusplus >= 201703L
+    UTEST_ASSERT_STR_EQUALS(std::string_view(text).substr(0, 5), "alpha");
+#endif
+
+    std::string message;
+    try {
+        UTEST_ASSERT_STR_EQUALS(text, "alpha");
+    } catch (const utest::AssertionException& e) {
+        message = e.what();
+    }
+    UTEST_ASSERT_STR_EQUALS(message, "String assertion failed: \"alpha beta\" != \"alpha\"");
+    try {
+        UTEST_ASSERT_STR_CONTAINS(text, "gamma");
+    } catch (const utest::AssertionException& e) {
+        message = e.what();
+    }
+    UTEST_ASSERT_STR_EQUALS(message, "String assertion failed: \"alpha beta\" does not contain \"gamma\"");
+    try {
+        UTEST_ASSERT_GT(1, 2);
+    } catch (const utest::AssertionException& e) {
+        message = e.what();
+    }
+    UTEST_ASSERT_STR_EQUALS(message, "Assertion failed: 1 is not greater than 2");
+    try {
+        UTEST_ASSERT_TRUE(text.empty());
+    } catch (const utest::AssertionException& e) {
+        message = e.what();
+    }
+    UTEST_ASSERT_STR_EQUALS(message, "condition is false: 'text.empty()'");
+}
+
+// Runs a container assertion and returns its failure message (empty when it passed)
+template<typename C1, typename C2>
+std::string containerAssertMessage(const C1& actual, const C2& expected) {
+    try {
+        UTEST_ASSERT_CONTAINER_EQUALS(actual, expected);
+    } catch (const utest::AssertionException& e) {
+        return e.what();
+    }
+    return std::string();
+}
+
+UTEST_FUNC_DEF2(ContainerAssert, EqualContainers) {
+    std::vector<int> values = {1, 2, 3};
+    std::vector<int> same = {1, 2, 3};
+    UTEST_ASSERT_CONTAINER_EQUALS(values, same);
+    UTEST_ASSERT_CONTAINER_EQUALS(std::vector<std::string>(), std::vector<std::string>());
+    
+    std::list<int> list = {1, 2, 3};
+    UTEST_ASSERT_CONTAINER_EQUALS(list, values);
+}
+
+UTEST_FUNC_DEF2(ContainerAssert, LargeVectorShowsWindowOnly) {
+    std::vector<int> actual(1000000);
+    for (std::size_t i = 0; i < actual.size(); ++i) {
+        actual[i] = static_cast<int>(i);
+    }
+    std::vector<int> expected = actual;
+    expected[500000] = -1;
+    
+    const std::string message = containerAssertMessage(actual, expected);
+    UTEST_ASSERT_STR_CONTAINS(message, "differ at index 500000 (sizes 1000000 and 1000000)");
+    UTEST_ASSERT_STR_CONTAINS(message, "actual[499997..500004) = [499997, 499998, 499999, 500000, 500001, 500002, 500003]");
+    UTEST_ASSERT_STR_CONTAINS(message, "expected[499997..500004) = [499997, 499998, 499999, -1, 500001, 500002, 500003]");
+    UTEST_ASSERT_TRUE(message.size() < 300);
+}
+
+UTEST_FUNC_DEF2(ContainerAssert, SizeMismatch) {
+    std::vector<int> actual = {1, 2, 3, 4};
+    std::vector<int> expected = {1, 2};
+    
+    const std::string message = containerAssertMessage(actual, expected);
+    UTEST_ASSERT_STR_CONTAINS(message, "differ at index 2 (sizes 4 and 2)");
+    UTEST_ASSERT_STR_CONTAINS(message, "actual[0..4) = [1, 2, 3, 4]");
+    UTEST_ASSERT_STR_CONTAINS(message, "expected[0..2) = [1, 2]");
+}
+
+UTEST_FUNC_DEF2(ContainerAssert, NonContiguousElements) {
+    std::list<std::string> actual = {"a", "b", "c"};
+    std::vector<std::string> expected = {"a", "x", "c"};
+    
+    const std::string message = containerAssertMessage(actual, expected);
+    UTEST_ASSERT_STR_CONTAINS(message, "differ at index 1 (sizes 3 and 3)");
+    UTEST_ASSERT_STR_CONTAINS(message, "actual[0..3) = [");
+    
+    std::vector<double> doubles = {0.5, 1.5};
+    std::vector<double> other = {0.5, 2.5};
+    UTEST_ASSERT_STR_CONTAINS(containerAssertMessage(doubles, other), "differ at index 1");
+}
+
+// Selection options parsed by UTEST_PROLOG(argc, argv)
+UTEST_FUNC_DEF2(UtestCommandLine, FilterAndShard) {
+    const utest::details::RunOptions savedOptions = utest::details::getRunOptions();
+    const bool savedAllowEmpty = utest::details::getAllowEmptyTests();
+    utest::details::getRunOptions() = utest::details::RunOptions();
+    
+    const char* argv[] = {"test", "--filter=Logfmt,Format*::Basic?laceholders", "--shard=1/2", "--repeat=3"};
+    utest::details::parseCommandLine(4, argv);
+    const utest::details::RunOptions options = utest::details::getRunOptions();
+    
+    std::vector<std::string> selected;
+    const char* names[][2] = {
+        {"Logfmt", "MapFields"}, {"Logfmt", "TupleOfPairs"}, {"AppendTo", "NumericTypes"},
+        {"FormatMacro", "BasicPlaceholders"}, {"Logfmt", "ReflectedStruct"}
+    };
+    for (const auto& name : names) {
+        utest::details::TestResult result;
+        result.group = name[0];
+        result.name = name[1];
+        if (utest::details::isTestSelected(result)) {
+            selected.push_back(utest::details::testDisplayName(result));
+        }
+    }
+    
+    utest::details::getRunOptions() = savedOptions;
+    utest::details::getAllowEmptyTests() = savedAllowEmpty;
+    
+    UTEST_ASSERT_EQUALS(options.filters.size(), 2u);
+    UTEST_ASSERT_EQUALS(options.repeat, 3ul);
+    UTEST_ASSERT_EQUALS(options.shardCount, 2ul);
+    UTEST_ASSERT_STR_EQUALS(ustr::to_string(selected), "[\"Logfmt::TupleOfPairs\", \"Logfmt::ReflectedStruct\"]");
+}
+
+#if UTEST_HAS_FORK_
+// Bodies run in forked workers by the isolation test below
+static void isolatedPass() {}
+static void isolatedFail() { UTEST_ASSERT_EQUALS(1, 2); }
+static void isolatedCrash() { std::abort(); }
+static void isolatedHang() { for (;;) { pause(); } }
+
+// Runs a nested isolated plan; its [FAIL] lines in the output are expected
+UTEST_FUNC_DEF2(UtestIsolation, CrashAndTimeoutAreReported) {
+    auto& results = utest::details::getTestResults();
+    const std::size_t before = results.size();
+    const bool savedIsolation = utest::details::getIsolationMode();
+    const long savedTimeout = utest::details::getTestTimeoutMs();
+    const unsigned savedJobs = utest::details::getParallelJobs();
+    const utest::details::RunOptions savedOptions = utest::details::getRunOptions();
+    utest::details::getRunOptions() = utest::details::RunOptions();
+    
+    UTEST_ENABLE_ISOLATION();
+    UTEST_SET_TEST_TIMEOUT_MS(200);
+    UTEST_SET_PARALLEL_JOBS(4);
+    bool failed = false;
+    utest::details::testFunc2("Isolated", "Pass", isolatedPass, failed);
+    utest::details::testFunc2("Isolated", "Fail", isolatedFail, failed);
+    utest::details::testFunc2("Isolated", "Crash", isolatedCrash, failed);
+    utest::details::testFunc2("Isolated", "Hang", isolatedHang, failed);
+    const std::size_t queued = utest::details::getPendingTests().size();
+    utest::details::runPendingTests(failed);
+    
+    std::vector<utest::details::TestResult> nested(results.begin() + static_cast<std::ptrdiff_t>(before), results.end());
+    results.resize(before);
+    utest::details::getIsolationMode() = savedIsolation;
+    utest::details::getTestTimeoutMs() = savedTimeout;
+    utest::details::getParallelJobs() = savedJobs;
+    utest::details::getRunOptions() = savedOptions;
+    
+    UTEST_ASSERT_EQUALS(queued, 4u);
+    UTEST_ASSERT_TRUE(failed);
+    UTEST_ASSERT_EQUALS(nested.size(), 4u);
+    UTEST_ASSERT_STR_EQUALS(nested[0].name, "Pass");
+    UTEST_ASSERT_TRUE(nested[0].passed);
+    UTEST_ASSERT_FALSE(nested[1].passed);
+    UTEST_ASSERT_STR_CONTAINS(nested[1].error, "Assertion failed: 1 != 2");
+    UTEST_ASSERT_FALSE(nested[2].passed);
+    UTEST_ASSERT_STR_CONTAINS(nested[2].error, "crashed with signal");
+    UTEST_ASSERT_FALSE(nested[3].passed);
+    UTEST_ASSERT_STR_EQUALS(nested[3].error, "timed out after 200ms");
+}
+#endif
+
+int main(int argc, char* argv[]) {
+    UTEST_PROLOG(argc, argv);
+    UTEST_ENABLE_VERBOSE_MODE();
+    UTEST_RUN_REGISTERED();
+    UTEST_EPILOG();
+}